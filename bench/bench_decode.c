@@ -0,0 +1,123 @@
+// CPU cost of playing the lofi library straight from the source files
+// versus from the transcode cache, and of the generated noise sources,
+// normalised to CPU seconds per hour of audio.
+//
+// usage: bench_decode <music directory>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <dirent.h>
+
+#include <SDL.h>
+#include <SDL_mixer.h>
+
+#include "transcode.h"
+#include "music.h"
+
+#define TMP_CACHE_FILE "bench_decode.tmp.wav"
+
+// Helper: CPU seconds spent fully decoding `path` into the device format.
+// Stores the decoded length (seconds of audio) in `audio_secs`.
+static double decode_cpu(const char *path, double *audio_secs) {
+    int freq, channels;
+    Uint16 format;
+    Mix_QuerySpec(&freq, &format, &channels);
+
+    clock_t t0 = clock();
+    Mix_Chunk *chunk = Mix_LoadWAV(path);
+    clock_t t1 = clock();
+    if (!chunk) return -1.0;
+
+    int frame = channels * SDL_AUDIO_BITSIZE(format) / 8;
+    *audio_secs = (double)chunk->alen / frame / freq;
+    Mix_FreeChunk(chunk);
+    return (double)(t1 - t0) / CLOCKS_PER_SEC;
+}
+
+static bool is_audio(const char *name) {
+    const char *dot = strrchr(name, '.');
+    return dot && (strcasecmp(dot, ".mp3") == 0
+                || strcasecmp(dot, ".ogg") == 0
+                || strcasecmp(dot, ".wav") == 0);
+}
+
+int main(int argc, char *argv[]) {
+    if (argc < 2) {
+        fprintf(stderr, "usage: %s <music directory>\n", argv[0]);
+        return 1;
+    }
+
+    // no sound card needed; we only measure decoding
+    SDL_setenv("SDL_AUDIODRIVER", "dummy", 0);
+    if (SDL_Init(SDL_INIT_AUDIO) != 0 ||
+        Mix_OpenAudio(44100, MIX_DEFAULT_FORMAT, 2, 1024) < 0) {
+        fprintf(stderr, "Audio init failed: %s\n", SDL_GetError());
+        return 1;
+    }
+
+    DIR *d = opendir(argv[1]);
+    if (!d) {
+        fprintf(stderr, "Could not open music directory: %s\n", argv[1]);
+        return 1;
+    }
+
+    double src_cpu = 0.0, cached_cpu = 0.0, audio_total = 0.0;
+    int tracks = 0;
+    struct dirent *ent;
+    while ((ent = readdir(d))) {
+        if (!is_audio(ent->d_name)) continue;
+
+        char path[2048];
+        snprintf(path, sizeof(path), "%s/%s", argv[1], ent->d_name);
+
+        double secs = 0.0, cached_secs = 0.0;
+        double c_src = decode_cpu(path, &secs);
+        if (c_src < 0.0 || transcode_file(path, TMP_CACHE_FILE) != 0) {
+            fprintf(stderr, "skipping %s: %s\n", ent->d_name, Mix_GetError());
+            continue;
+        }
+        double c_cached = decode_cpu(TMP_CACHE_FILE, &cached_secs);
+        remove(TMP_CACHE_FILE);
+
+        printf("%-48s %7.1fs audio  source %.3fs  cached %.3fs CPU\n",
+               ent->d_name, secs, c_src, c_cached);
+        src_cpu     += c_src;
+        cached_cpu  += c_cached;
+        audio_total += secs;
+        tracks++;
+    }
+    closedir(d);
+
+    if (tracks == 0 || audio_total <= 0.0) {
+        fprintf(stderr, "No decodable tracks found.\n");
+        return 1;
+    }
+
+    double hours = audio_total / 3600.0;
+    printf("\n%d tracks, %.1f minutes of audio\n", tracks, audio_total / 60.0);
+    printf("CPU per hour of playback: source %.2fs, cached %.2fs (%.0f%% less)\n",
+           src_cpu / hours, cached_cpu / hours,
+           src_cpu > 0.0 ? 100.0 * (1.0 - cached_cpu / src_cpu) : 0.0);
+
+    // the same hour from the noise generator, at the device format
+    int freq, channels;
+    Uint16 format;
+    Mix_QuerySpec(&freq, &format, &channels);
+    static Uint8 buf[4096];
+    long calls = (long)freq * channels * (SDL_AUDIO_BITSIZE(format) / 8) * 3600 / sizeof(buf);
+    printf("\nGenerated noise, CPU per hour of playback:\n");
+    for (int type = AMBIENT_WHITE; type < AMBIENT_COUNT; type++) {
+        cycle_ambient();
+        clock_t t0 = clock();
+        for (long i = 0; i < calls; i++) ambient_noise_mixer(NULL, buf, sizeof(buf));
+        clock_t t1 = clock();
+        printf("  %-6s %.2fs\n", type == AMBIENT_WHITE ? "white" : type == AMBIENT_PINK ? "pink"
+                              : type == AMBIENT_BROWN ? "brown" : "rain",
+               (double)(t1 - t0) / CLOCKS_PER_SEC);
+    }
+
+    Mix_CloseAudio();
+    SDL_Quit();
+    return 0;
+}
@@ -0,0 +1,54 @@
+#!/usr/bin/env bash
+# Run one session headless (offscreen renderer, dummy audio driver) and report the CPU,
+# context switches, wakeups, mixer CPU and peak RSS it used.
+# usage: bench/bench_energy.sh ./study-with-this [hours] [speed] [baseline.json]
+# speed is the clock factor: 1 = real time. The schedule comes from settings.json,
+# capped at `hours`; keep the same settings when comparing commits.
+set -euo pipefail
+
+APP=${1:?usage: $0 <app> [hours] [speed] [baseline.json]}
+HOURS=${2:-4}
+SPEED=${3:-60}
+BASELINE=${4:-}
+REV=$(git rev-parse --short HEAD 2>/dev/null || echo unknown)
+OUT="bench/energy-$REV.json"
+
+# start on the next minute so there is no lead-in break
+START=$(date -d '+1 minute' +%H:%M 2>/dev/null || date -v+1M +%H:%M)
+SECONDS_TOTAL=$(awk -v h="$HOURS" 'BEGIN { print h * 3600 }')
+
+if awk -v s="$SPEED" 'BEGIN { exit !(s == 1) }'; then
+    CLOCK=()
+else
+    CLOCK=(--clock-speed "$SPEED")
+fi
+
+SDL_AUDIODRIVER=dummy "$APP" --headless 1280x800 --start "$START" "${CLOCK[@]}" \
+    --duration "$SECONDS_TOTAL" --bench-energy "$OUT"
+
+# the report is flat JSON, one "key": value per line
+value() {
+    awk -F'[":,]+' -v k="$2" '$2 == k { gsub(/[ \t]/, "", $3); print $3 }' "$1"
+}
+
+KEYS="wall_s simulated_s cpu_user_s cpu_system_s voluntary_switches involuntary_switches
+      wakeups audio_thread_cpu_s peak_rss_kb cpu_s_per_sim_hour wakeups_per_sim_hour
+      switches_per_sim_hour audio_cpu_s_per_wall_hour"
+
+echo "report: $OUT"
+if [ -z "$BASELINE" ]; then
+    for k in $KEYS; do
+        printf "%-28s %14s\n" "$k" "$(value "$OUT" "$k")"
+    done
+    exit 0
+fi
+
+printf "%-28s %14s %14s %9s\n" metric baseline current change
+for k in $KEYS; do
+    old=$(value "$BASELINE" "$k")
+    new=$(value "$OUT" "$k")
+    awk -v k="$k" -v a="$old" -v b="$new" 'BEGIN {
+        if (a > 0 && b >= 0) printf "%-28s %14s %14s %+8.1f%%\n", k, a, b, (b - a) * 100 / a
+        else                 printf "%-28s %14s %14s %9s\n", k, a, b, "-"
+    }'
+done
@@ -0,0 +1,174 @@
+// Per-frame cost of the session screen (draw_pie, render_countdown, draw_panel),
+// drawn offscreen by the software renderer so it runs without a display or GPU,
+// and an image check of one fixed frame against a golden copy.
+//
+// usage: bench_render [WxH] [frames] [--save frame.ppm] [--golden golden.ppm]
+// --save writes the fixed frame; --golden compares it and exits 1 on a mismatch.
+// Record a golden frame with --save on a known-good commit, on the same machine:
+// font rasterization differs between FreeType versions.
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <SDL.h>
+
+#include "graphics.h"
+#include "timefmt.h"
+
+#define BASE_TIME       1700000000   // fixed clock for the panel, in UTC
+#define SESSIONS        4
+#define CHANNEL_SLACK   16           // per-channel difference still counted as equal
+#define MAX_BAD_PERMIL  5            // differing pixels allowed, per thousand
+
+static double seconds(Uint64 ticks) {
+    return (double)ticks / SDL_GetPerformanceFrequency();
+}
+
+static int compare_double(const void *a, const void *b) {
+    double x = *(const double *)a, y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+// Helper: mean, p50 and p99 of `n` samples in microseconds; sorts them
+static void report(const char *name, double *us, int n) {
+    double sum = 0.0;
+    for (int i = 0; i < n; i++) sum += us[i];
+    qsort(us, n, sizeof(double), compare_double);
+    printf("%-18s mean %8.1f us   p50 %8.1f   p99 %8.1f\n",
+           name, sum / n, us[(n - 1) * 50 / 100], us[(n - 1) * 99 / 100]);
+}
+
+// Helper: load a binary PPM written by graphics_capture_frame(); NULL on error
+static unsigned char *read_ppm(const char *path, int *w, int *h) {
+    FILE *f = fopen(path, "rb");
+    if (!f) return NULL;
+    int maxval;
+    unsigned char *rgb = NULL;
+    if (fscanf(f, "P6 %d %d %d", w, h, &maxval) == 3 && maxval == 255 && fgetc(f) != EOF) {
+        size_t len = (size_t)*w * *h * 3;
+        rgb = malloc(len);
+        if (rgb && fread(rgb, 1, len, f) != len) {
+            free(rgb);
+            rgb = NULL;
+        }
+    }
+    fclose(f);
+    return rgb;
+}
+
+// Helper: 0 when the two frames match within the slack
+static int compare_frames(const char *current, const char *golden) {
+    int w1, h1, w2, h2;
+    unsigned char *a = read_ppm(current, &w1, &h1);
+    unsigned char *b = read_ppm(golden, &w2, &h2);
+    int rc = 1;
+    if (!a || !b) {
+        fprintf(stderr, "Cannot read %s\n", !a ? current : golden);
+    } else if (w1 != w2 || h1 != h2) {
+        fprintf(stderr, "Size differs: %dx%d vs golden %dx%d\n", w1, h1, w2, h2);
+    } else {
+        long bad = 0, pixels = (long)w1 * h1;
+        for (long p = 0; p < pixels; p++) {
+            for (int c = 0; c < 3; c++) {
+                if (abs(a[p * 3 + c] - b[p * 3 + c]) > CHANNEL_SLACK) {
+                    bad++;
+                    break;
+                }
+            }
+        }
+        printf("golden: %ld of %ld pixels differ\n", bad, pixels);
+        rc = bad * 1000 > pixels * MAX_BAD_PERMIL;
+    }
+    free(a);
+    free(b);
+    return rc;
+}
+
+int main(int argc, char *argv[]) {
+    int width = 1280, height = 800, frames = 2000;
+    const char *save = NULL, *golden = NULL;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--save") == 0 && i + 1 < argc) {
+            save = argv[++i];
+        } else if (strcmp(argv[i], "--golden") == 0 && i + 1 < argc) {
+            golden = argv[++i];
+        } else if (strchr(argv[i], 'x')) {
+            sscanf(argv[i], "%dx%d", &width, &height);
+        } else {
+            frames = atoi(argv[i]);
+        }
+    }
+    if (frames <= 0) frames = 2000;
+    if (golden && !save) save = "render-current.ppm";
+
+    // the panel's clock and timetable must not depend on the machine's zone
+    putenv("TZ=UTC");
+    timefmt_invalidate();
+
+    if (init_graphics_headless(width, height) != 0 || graphics_load_deferred_fonts() != 0) {
+        fprintf(stderr, "Headless graphics failed: %s\n", SDL_GetError());
+        return 1;
+    }
+
+    time_t starts[SESSIONS], ends[SESSIONS];
+    for (int i = 0; i < SESSIONS; i++) {
+        starts[i] = BASE_TIME + i * 1800;
+        ends[i]   = starts[i] + 1500;
+    }
+
+    double *pie   = malloc(sizeof(double) * frames);
+    double *count = malloc(sizeof(double) * frames);
+    double *panel = malloc(sizeof(double) * frames);
+    double *frame = malloc(sizeof(double) * frames);
+    if (!pie || !count || !panel || !frame) return 1;
+
+    // a work session counting down, one simulated second per frame
+    for (int f = 0; f < frames; f++) {
+        int left = 1500 - f % 1500;
+        Uint64 t0 = SDL_GetPerformanceCounter();
+        graphics_begin_frame();
+        Uint64 t1 = SDL_GetPerformanceCounter();
+        draw_pie(left / 1500.0, WORK);
+        Uint64 t2 = SDL_GetPerformanceCounter();
+        render_countdown(left, WORK);
+        Uint64 t3 = SDL_GetPerformanceCounter();
+        draw_panel((time_t)(BASE_TIME + f), 0, starts, ends, SESSIONS);
+        Uint64 t4 = SDL_GetPerformanceCounter();
+        graphics_end_frame();
+        Uint64 t5 = SDL_GetPerformanceCounter();
+
+        pie[f]   = seconds(t2 - t1) * 1e6;
+        count[f] = seconds(t3 - t2) * 1e6;
+        panel[f] = seconds(t4 - t3) * 1e6;
+        frame[f] = seconds(t5 - t0) * 1e6;
+    }
+
+    printf("%dx%d, %d frames, software renderer\n", width, height, frames);
+    report("draw_pie", pie, frames);
+    report("render_countdown", count, frames);
+    report("draw_panel", panel, frames);
+    report("whole frame", frame, frames);
+
+    // one fixed frame for the image check
+    int rc = 0;
+    if (save) {
+        track_scroll = 0;
+        graphics_begin_frame();
+        draw_pie(0.4, WORK);
+        render_countdown(754, WORK);
+        draw_panel((time_t)(BASE_TIME + 123), 1, starts, ends, SESSIONS);
+        rc = graphics_capture_frame(save);
+        graphics_end_frame();
+        if (rc == 0 && golden) {
+            rc = compare_frames(save, golden);
+        }
+    }
+
+    free(pie);
+    free(count);
+    free(panel);
+    free(frame);
+    cleanup_graphics();
+    return rc;
+}
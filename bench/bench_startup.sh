@@ -0,0 +1,32 @@
+#!/usr/bin/env bash
+# Launch the app repeatedly with --profile-startup and report percentiles of
+# each startup phase and of the time to the first frame.
+# usage: bench/bench_startup.sh ./study-with-this [runs]
+# Needs a display; every run opens the window, presents one frame and exits.
+set -euo pipefail
+
+APP=${1:?usage: $0 <app> [runs]}
+RUNS=${2:-20}
+OUT=$(mktemp)
+trap 'rm -f "$OUT"' EXIT
+
+for ((i = 0; i < RUNS; i++)); do
+    # first_frame has one number (at_ms); phases report took_ms in the third column
+    "$APP" --profile-startup | awk '
+        $1 == "phase"       { next }
+        $1 == "first_frame" { print $1, $2; next }
+                            { print $1, $3 }' >> "$OUT"
+done
+
+printf "%-24s %5s %10s %10s %10s %10s\n" phase runs p50_ms p90_ms p99_ms max_ms
+# a phase that runs several times per launch (font loads) counts each time
+for phase in $(awk '{ print $1 }' "$OUT" | awk '!seen[$0]++'); do
+    awk -v p="$phase" '$1 == p { print $2 }' "$OUT" | sort -g | awk -v p="$phase" '
+        { v[NR] = $1 }
+        END {
+            i50 = int(NR * 0.50 + 0.999); if (i50 < 1) i50 = 1
+            i90 = int(NR * 0.90 + 0.999); if (i90 < 1) i90 = 1
+            i99 = int(NR * 0.99 + 0.999); if (i99 < 1) i99 = 1
+            printf "%-24s %5d %10.3f %10.3f %10.3f %10.3f\n", p, NR, v[i50], v[i90], v[i99], v[NR]
+        }'
+done
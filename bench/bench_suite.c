@@ -0,0 +1,347 @@
+// Micro-benchmarks of the hot paths: drawing, the shuffle pick, the volume path,
+// load_settings and cJSON on the documents the app reads and writes. Each case is
+// warmed up, then timed in REPS batches; the batch size grows until one batch takes
+// at least BATCH_MIN_NS. Results go out as JSON, one object per case, with the
+// median and p99 of ns/op over the batches and allocations/op through SDL_malloc.
+//
+// usage: bench_suite [out.json]        (stdout when no file is given)
+// Runs headless with the dummy audio driver. HOME points at bench/bench-home so
+// load_settings() never touches the real settings file (POSIX only: Windows finds
+// Documents through the shell). The shuffle library always goes under bench-home and
+// is deleted afterwards.
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <SDL.h>
+
+#include "alloc_stats.h"
+#include "cJSON.h"
+#include "graphics.h"
+#include "music.h"
+#include "platform.h"
+#include "settings.h"
+#include "timefmt.h"
+
+#define WARMUP_REPS   3
+#define REPS          31
+#define BATCH_MIN_NS  1000000ULL     // 1 ms per batch
+#define MAX_BATCH     (1 << 20)
+#define BASE_TIME     1700000000     // fixed clock for the panel, in UTC
+#define LIBRARY_SIZE  60             // empty tracks for the shuffle pick
+#define LOG_EVENTS    1000
+#define BENCH_HOME    "bench/bench-home"
+#define BENCH_MUSIC   BENCH_HOME "/music/"   // the library, on every platform
+
+typedef void (*BenchFn)(void *arg, int iter);
+
+static cJSON *results = NULL;
+
+static Uint64 now_ns(void) {
+    return (Uint64)((double)SDL_GetPerformanceCounter() * 1e9 / SDL_GetPerformanceFrequency());
+}
+
+static int compare_double(const void *a, const void *b) {
+    double x = *(const double *)a, y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+// Helper: time `ops` calls of fn, in ns
+static Uint64 run_batch(BenchFn fn, void *arg, int ops, int *iter) {
+    Uint64 t0 = now_ns();
+    for (int i = 0; i < ops; i++) {
+        fn(arg, (*iter)++);
+    }
+    return now_ns() - t0;
+}
+
+// Warm up, size the batch, time REPS batches and append the case to the results
+static void bench(const char *name, BenchFn fn, void *arg) {
+    int iter = 0;
+    int ops = 1;
+    for (int i = 0; i < WARMUP_REPS; i++) {
+        run_batch(fn, arg, ops, &iter);
+    }
+    while (ops < MAX_BATCH && run_batch(fn, arg, ops, &iter) < BATCH_MIN_NS) {
+        ops *= 2;
+    }
+
+    double per_op[REPS];
+    AllocCounts mark = alloc_stats_thread();
+    for (int r = 0; r < REPS; r++) {
+        per_op[r] = (double)run_batch(fn, arg, ops, &iter) / ops;
+    }
+    AllocCounts allocs = alloc_stats_since(mark);
+    qsort(per_op, REPS, sizeof(double), compare_double);
+
+    double total_ops = (double)REPS * ops;
+    double median = per_op[REPS / 2];
+    double p99 = per_op[(REPS - 1) * 99 / 100];
+    fprintf(stderr, "%-32s %12.1f ns/op   p99 %12.1f   %8.2f allocs/op\n",
+            name, median, p99, allocs.count / total_ops);
+
+    cJSON *item = cJSON_CreateObject();
+    cJSON_AddStringToObject(item, "name", name);
+    cJSON_AddNumberToObject(item, "ops_per_rep", ops);
+    cJSON_AddNumberToObject(item, "reps", REPS);
+    cJSON_AddNumberToObject(item, "median_ns_per_op", median);
+    cJSON_AddNumberToObject(item, "p99_ns_per_op", p99);
+    cJSON_AddNumberToObject(item, "allocs_per_op", allocs.count / total_ops);
+    cJSON_AddNumberToObject(item, "alloc_bytes_per_op", allocs.bytes / total_ops);
+    cJSON_AddItemToArray(results, item);
+}
+
+// ---- drawing ----
+// One op draws into the current frame and flushes the renderer's command queue,
+// so the rasterization is counted and nothing piles up between presents.
+
+static void op_pie(void *arg, int iter) {
+    (void)iter;
+    draw_pie(*(const double *)arg, WORK);
+    SDL_RenderFlush(get_renderer());
+}
+
+static void op_countdown(void *arg, int iter) {
+    (void)arg;
+    render_countdown(1500 - iter % 1500, WORK);
+    SDL_RenderFlush(get_renderer());
+}
+
+typedef struct {
+    int     sessions;
+    time_t *starts;
+    time_t *ends;
+} PanelCase;
+
+static void op_panel(void *arg, int iter) {
+    PanelCase *c = arg;
+    draw_panel((time_t)(BASE_TIME + iter % 1800), 0, c->starts, c->ends, c->sessions);
+    SDL_RenderFlush(get_renderer());
+}
+
+// The pie's radius follows the window's shorter side, so each size is one radius
+static int bench_drawing(void) {
+    static const int sizes[][2] = { { 640, 400 }, { 1280, 800 }, { 2560, 1600 } };
+    static const double fractions[] = { 0.1, 0.5, 0.9 };
+    static const int session_counts[] = { 5, 50, 500 };
+    char name[64];
+
+    for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++) {
+        int w = sizes[s][0], h = sizes[s][1];
+        if (init_graphics_headless(w, h) != 0 || graphics_load_deferred_fonts() != 0) {
+            fprintf(stderr, "Headless graphics failed: %s\n", SDL_GetError());
+            return 1;
+        }
+        graphics_begin_frame();
+
+        for (size_t f = 0; f < sizeof(fractions) / sizeof(fractions[0]); f++) {
+            snprintf(name, sizeof(name), "draw_pie/%dx%d/%.1f", w, h, fractions[f]);
+            bench(name, op_pie, (void *)&fractions[f]);
+        }
+
+        // text and the panel do not change with the size; one size is enough
+        if (w == 1280) {
+            bench("render_countdown", op_countdown, NULL);
+
+            for (size_t n = 0; n < sizeof(session_counts) / sizeof(session_counts[0]); n++) {
+                PanelCase c;
+                c.sessions = session_counts[n];
+                c.starts = malloc(sizeof(time_t) * c.sessions);
+                c.ends   = malloc(sizeof(time_t) * c.sessions);
+                if (!c.starts || !c.ends) return 1;
+                for (int i = 0; i < c.sessions; i++) {
+                    c.starts[i] = BASE_TIME + (time_t)i * 1800;
+                    c.ends[i]   = c.starts[i] + 1500;
+                }
+                snprintf(name, sizeof(name), "draw_panel/%d_sessions", c.sessions);
+                bench(name, op_panel, &c);
+                free(c.starts);
+                free(c.ends);
+            }
+        }
+
+        graphics_end_frame();
+        cleanup_graphics();
+    }
+    return 0;
+}
+
+// ---- audio ----
+
+static void op_pick(void *arg, int iter) {
+    (void)arg;
+    (void)iter;
+    pick_lofi_track();
+}
+
+// The hotkeys step the volume up and down; alternate so it never sticks at a bound
+static void op_volume(void *arg, int iter) {
+    (void)arg;
+    adjust_volume((iter & 1) ? -8 : 8);
+}
+
+static int bench_audio(const Settings *loaded) {
+    Settings s = *loaded;
+    s.transcode_cache = 0;
+    s.normalize_loudness = 0;
+    s.visualizer = 0;
+    snprintf(s.ambient, sizeof(s.ambient), "lofi");
+    snprintf(s.alarm_synth, sizeof(s.alarm_synth), "bell");
+    snprintf(s.music_directory, sizeof(s.music_directory), "%s", BENCH_MUSIC);
+    if (platform_mkdir_p(BENCH_MUSIC) != 0) {
+        fprintf(stderr, "Cannot create %s\n", BENCH_MUSIC);
+        return 1;
+    }
+
+    // empty files are enough: the pick only checks that a track opens
+    int rc = 0;
+    for (int i = 0; i < LIBRARY_SIZE && rc == 0; i++) {
+        char path[MAX_PATH_LEN + 32];
+        snprintf(path, sizeof(path), "%strack%02d.mp3", BENCH_MUSIC, i);
+        FILE *f = fopen(path, "ab");
+        if (!f) {
+            fprintf(stderr, "Cannot create %s\n", path);
+            rc = 1;
+        } else {
+            fclose(f);
+        }
+    }
+
+    if (rc == 0 && !init_audio(&s)) {
+        const char *err = get_last_audio_error();
+        fprintf(stderr, "Audio init failed: %s\n", err ? err : SDL_GetError());
+        rc = 1;
+    }
+    if (rc == 0) {
+        bench("play_lofi/shuffle_pick", op_pick, NULL);
+        bench("adjust_volume", op_volume, NULL);
+        cleanup_audio();
+    }
+
+    for (int i = 0; i < LIBRARY_SIZE; i++) {
+        char path[MAX_PATH_LEN + 32];
+        snprintf(path, sizeof(path), "%strack%02d.mp3", BENCH_MUSIC, i);
+        remove(path);
+    }
+    return rc;
+}
+
+// ---- settings and documents ----
+
+static void op_load_settings(void *arg, int iter) {
+    (void)iter;
+    *(Settings *)arg = load_settings();
+}
+
+static void op_parse(void *arg, int iter) {
+    (void)iter;
+    cJSON_Delete(cJSON_Parse(arg));
+}
+
+static void op_print(void *arg, int iter) {
+    (void)iter;
+    cJSON_free(cJSON_Print(arg));
+}
+
+// Helper: a trace like the one TRACE=1 builds write, LOG_EVENTS slices long
+static cJSON *make_log_document(void) {
+    cJSON *root = cJSON_CreateObject();
+    cJSON *events = cJSON_AddArrayToObject(root, "traceEvents");
+    for (int i = 0; i < LOG_EVENTS; i++) {
+        cJSON *e = cJSON_CreateObject();
+        cJSON_AddStringToObject(e, "name", (i % 3 == 0) ? "draw_pie" : (i % 3 == 1) ? "draw_panel" : "engine_poll");
+        cJSON_AddStringToObject(e, "ph", "X");
+        cJSON_AddNumberToObject(e, "ts", 16667.0 * i);
+        cJSON_AddNumberToObject(e, "dur", 120.0 + i % 40);
+        cJSON_AddNumberToObject(e, "pid", 1);
+        cJSON_AddNumberToObject(e, "tid", 1 + i % 4);
+        cJSON_AddItemToArray(events, e);
+    }
+    return root;
+}
+
+// Helper: settings.json as the app writes it, read back from disk
+static char *read_file(const char *path) {
+    FILE *f = fopen(path, "rb");
+    if (!f) return NULL;
+    fseek(f, 0, SEEK_END);
+    long size = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    char *buffer = malloc(size + 1);
+    if (buffer) {
+        size_t got = fread(buffer, 1, size, f);
+        buffer[got] = '\0';
+    }
+    fclose(f);
+    return buffer;
+}
+
+static int bench_documents(Settings *loaded) {
+    bench("load_settings", op_load_settings, loaded);
+
+    char *settings_text = read_file(get_settings_path());
+    cJSON *settings_doc = settings_text ? cJSON_Parse(settings_text) : NULL;
+    if (!settings_doc) {
+        fprintf(stderr, "Cannot read %s\n", get_settings_path());
+        free(settings_text);
+        return 1;
+    }
+    bench("cjson/settings_parse", op_parse, settings_text);
+    bench("cjson/settings_print", op_print, settings_doc);
+
+    cJSON *log_doc = make_log_document();
+    char *log_text = cJSON_Print(log_doc);
+    bench("cjson/log_parse", op_parse, log_text);
+    bench("cjson/log_print", op_print, log_doc);
+
+    cJSON_free(log_text);
+    cJSON_Delete(log_doc);
+    cJSON_Delete(settings_doc);
+    free(settings_text);
+    return 0;
+}
+
+int main(int argc, char *argv[]) {
+    // before anything reaches SDL_malloc
+    if (alloc_stats_install() != 0) {
+        fprintf(stderr, "Could not install the allocation counters\n");
+        return 1;
+    }
+
+    // a throwaway settings file, and a panel that does not depend on the zone
+    if (platform_mkdir_p(BENCH_HOME) != 0) {
+        fprintf(stderr, "Cannot create %s\n", BENCH_HOME);
+        return 1;
+    }
+    SDL_setenv("HOME", BENCH_HOME, 1);
+    SDL_setenv("SDL_AUDIODRIVER", "dummy", 1);
+    putenv("TZ=UTC");
+    timefmt_invalidate();
+
+    results = cJSON_CreateArray();
+    Settings settings = load_settings();
+
+    int rc = bench_drawing();
+    if (rc == 0) rc = bench_audio(&settings);
+    if (rc == 0) rc = bench_documents(&settings);
+
+    cJSON *root = cJSON_CreateObject();
+    cJSON_AddStringToObject(root, "suite", "study-with-this");
+    cJSON_AddNumberToObject(root, "warmup_reps", WARMUP_REPS);
+    cJSON_AddItemToObject(root, "results", results);
+    char *json = cJSON_Print(root);
+    cJSON_Delete(root);
+    if (!json) return 1;
+
+    FILE *out = (argc > 1) ? fopen(argv[1], "w") : stdout;
+    if (!out) {
+        fprintf(stderr, "Cannot write %s\n", argv[1]);
+        rc = 1;
+    } else {
+        fprintf(out, "%s\n", json);
+        if (out != stdout) fclose(out);
+    }
+    cJSON_free(json);
+    return rc;
+}
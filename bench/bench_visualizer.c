@@ -0,0 +1,77 @@
+// Per-frame cost of the spectrum visualizer: the post-mix capture on the audio
+// thread, the analysis (drain + window + FFT + bands) and the batched draw.
+//
+// usage: bench_visualizer [frames]
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+
+#include <SDL.h>
+#include <SDL_mixer.h>
+
+#include "visualizer.h"
+
+#define CALLBACK_BYTES 4096   // one 1024-frame S16 stereo mixer callback
+
+static double seconds(Uint64 ticks) {
+    return (double)ticks / SDL_GetPerformanceFrequency();
+}
+
+int main(int argc, char *argv[]) {
+    int frames = argc > 1 ? atoi(argv[1]) : 10000;
+    if (frames <= 0) frames = 10000;
+
+    SDL_setenv("SDL_AUDIODRIVER", "dummy", 0);
+    if (SDL_Init(SDL_INIT_AUDIO) != 0 ||
+        Mix_OpenAudio(48000, AUDIO_S16SYS, 2, 1024) < 0 ||
+        visualizer_start() != 0) {
+        fprintf(stderr, "Audio init failed: %s\n", SDL_GetError());
+        return 1;
+    }
+    // the dummy device also calls the capture; take it off so only we feed the ring
+    Mix_SetPostMix(NULL, NULL);
+
+    // an offscreen software renderer stands in for the window
+    SDL_Surface *target = SDL_CreateRGBSurfaceWithFormat(0, 800, 500, 32, SDL_PIXELFORMAT_ARGB8888);
+    SDL_Renderer *renderer = target ? SDL_CreateSoftwareRenderer(target) : NULL;
+    if (!renderer) {
+        fprintf(stderr, "Software renderer failed: %s\n", SDL_GetError());
+        return 1;
+    }
+
+    static Sint16 pcm[CALLBACK_BYTES / 2];
+    for (int i = 0; i < CALLBACK_BYTES / 4; i++) {
+        Sint16 v = (Sint16)(8000.0 * sin(i * 0.13) + 4000.0 * sin(i * 0.017));
+        pcm[2 * i] = pcm[2 * i + 1] = v;
+    }
+
+    Uint64 t_capture = 0, t_analyse = 0, t_render = 0;
+    for (int f = 0; f < frames; f++) {
+        Uint64 t0 = SDL_GetPerformanceCounter();
+        visualizer_capture(NULL, (Uint8 *)pcm, CALLBACK_BYTES);
+        Uint64 t1 = SDL_GetPerformanceCounter();
+        visualizer_analyse();
+        Uint64 t2 = SDL_GetPerformanceCounter();
+        visualizer_capture(NULL, (Uint8 *)pcm, CALLBACK_BYTES);
+        Uint64 t3 = SDL_GetPerformanceCounter();
+        visualizer_render(renderer, 280, 150, 125);   // analyse + draw
+        Uint64 t4 = SDL_GetPerformanceCounter();
+
+        t_capture += (t1 - t0) + (t3 - t2);
+        t_analyse += t2 - t1;
+        t_render  += t4 - t3;
+    }
+
+    printf("capture  %8.0f ns per %d-byte callback (audio thread)\n",
+           seconds(t_capture) * 1e9 / (2.0 * frames), CALLBACK_BYTES);
+    printf("analyse  %8.0f ns per frame\n", seconds(t_analyse) * 1e9 / frames);
+    printf("render   %8.0f ns per frame (analyse + one SDL_RenderGeometry)\n",
+           seconds(t_render) * 1e9 / frames);
+
+    SDL_DestroyRenderer(renderer);
+    SDL_FreeSurface(target);
+    visualizer_stop();
+    Mix_CloseAudio();
+    SDL_Quit();
+    return 0;
+}
@@ -0,0 +1,79 @@
+#!/usr/bin/env bash
+# Soak test: run the app headless over an accelerated day with constant track changes,
+# alarms, volume/mute/skip presses and error screens (--soak), and fail if RSS or the
+# heap kept growing. Uses its own HOME with a generated library, so the real settings
+# and music are never touched. A broken track keeps play_lofi()'s error path busy.
+# usage: bench/soak.sh ./study-with-this [hours] [speed]
+# speed is the clock factor; "step" (the default) runs as fast as frames can be drawn.
+set -euo pipefail
+
+APP=${1:?usage: $0 <app> [hours] [speed]}
+HOURS=${2:-24}
+SPEED=${3:-step}
+OUT="bench/soak-samples.csv"
+SOAK_HOME="$(pwd)/bench/soak-home"
+RES="$SOAK_HOME/Documents/Study-with-me/resource"
+
+le16() { printf "\\x$(printf %02x $(($1 & 255)))\\x$(printf %02x $(($1 >> 8 & 255)))"; }
+le32() { le16 $(($1 & 65535)); le16 $(($1 >> 16)); }
+
+# silent 16-bit mono WAV of $2 seconds
+silent_wav() {
+    local n=$(($2 * 22050 * 2))
+    {
+        printf 'RIFF'; le32 $((36 + n)); printf 'WAVEfmt '
+        le32 16; le16 1; le16 1; le32 22050; le32 44100; le16 2; le16 16
+        printf 'data'; le32 "$n"
+        head -c "$n" /dev/zero
+    } > "$1"
+}
+
+rm -rf "$SOAK_HOME"
+mkdir -p "$RES/sound/lofi"
+for i in 1 2 3 4 5 6; do
+    silent_wav "$RES/sound/lofi/track$i.wav" $((i + 2))
+done
+printf 'not audio' > "$RES/sound/lofi/broken.mp3"
+silent_wav "$RES/sound/alarm.wav" 1
+
+cat > "$RES/settings.json" <<EOF
+{
+  "work_time": 25,
+  "break_time": 5,
+  "num_sessions": 4,
+  "long_break_time": 15,
+  "long_break_every": 4,
+  "width": 800,
+  "height": 500,
+  "asset_directory": "$RES/sound",
+  "music_directory": "lofi",
+  "ambient": "lofi",
+  "alarm_sound": "alarm.wav",
+  "alarm_synth": "",
+  "lid_con": 0,
+  "transcode_cache": 0,
+  "normalize_loudness": 0,
+  "visualizer": 0,
+  "log_file": 0
+}
+EOF
+
+if [ "$SPEED" = step ]; then
+    CLOCK=(--clock-step)
+else
+    CLOCK=(--clock-speed "$SPEED")
+fi
+
+# start on the next minute so there is no lead-in break
+START=$(date -d '+1 minute' +%H:%M 2>/dev/null || date -v+1M +%H:%M)
+SECONDS_TOTAL=$(awk -v h="$HOURS" 'BEGIN { print h * 3600 }')
+
+status=0
+HOME="$SOAK_HOME" SDL_AUDIODRIVER=dummy "$APP" --headless 800x500 --start "$START" \
+    "${CLOCK[@]}" --duration "$SECONDS_TOTAL" --soak "$OUT" || status=$?
+
+echo "samples: $OUT"
+if [ "$status" -ne 0 ]; then
+    echo "soak: FAILED (memory kept growing, or the app exited with $status)"
+fi
+exit "$status"
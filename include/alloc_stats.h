@@ -0,0 +1,29 @@
+#ifndef ALLOC_STATS_H
+#define ALLOC_STATS_H
+
+#include <stdint.h>
+
+// Heap allocation accounting for --alloc-stats. Counting allocators are installed
+// with SDL_SetMemoryFunctions and cJSON_InitHooks, so SDL, SDL_ttf, SDL_mixer and
+// cJSON allocations are seen; plain malloc() (FreeType, codecs, drivers) is not.
+// Counts are per thread, so a frame on the main thread is not blurred by the
+// mixer's callbacks.
+
+typedef struct {
+    uint64_t count;   // malloc, calloc and realloc calls
+    uint64_t bytes;   // bytes requested by them
+} AllocCounts;
+
+// Install the counting allocators. Call before the first SDL or cJSON call;
+// installing later is refused, since SDL may already hold memory. Returns 0 on success.
+int alloc_stats_install(void);
+
+int alloc_stats_installed(void);
+
+// Everything the calling thread has allocated so far. Zero when not installed.
+AllocCounts alloc_stats_thread(void);
+
+// What the calling thread allocated since `mark` (an earlier alloc_stats_thread()).
+AllocCounts alloc_stats_since(AllocCounts mark);
+
+#endif
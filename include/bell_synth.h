@@ -0,0 +1,20 @@
+#ifndef BELL_SYNTH_H
+#define BELL_SYNTH_H
+
+#include <SDL_mixer.h>
+
+// Synthesized alarm: a bank of damped oscillators rendered in a mixer effect,
+// so the alarm needs no file, no decoding and only a tiny silent carrier chunk.
+
+// Select a preset ("bell", "chime" or "bowl").
+// Returns the carrier chunk to use as the alarm chunk (volume applies to it as usual),
+// or NULL if the preset is unknown.
+Mix_Chunk *bell_synth_init(const char *preset);
+
+// Strike the bell on a free channel. Returns the channel, or -1 on error.
+int bell_synth_play(void);
+
+// Release the carrier chunk.
+void bell_synth_free(void);
+
+#endif
@@ -0,0 +1,14 @@
+#ifndef ENERGY_H
+#define ENERGY_H
+
+// Resource accounting for --bench-energy: CPU time, context switches, wakeups,
+// mixer thread CPU and peak RSS over a session, written as JSON so runs on
+// different commits can be compared (see bench/bench_energy.sh).
+
+// Start measuring. Call right before the session starts.
+void energy_begin(void);
+
+// Write what was used since energy_begin() to `path`. Returns 0 on success.
+int energy_write_report(const char *path);
+
+#endif
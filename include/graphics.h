@@ -13,9 +13,17 @@ typedef enum {
     START_SCREEN_SETTINGS = 2
 } StartScreenResult;
 
-// Initialize SDL window and renderer
+// Initialize SDL window and renderer, and the one font the start screen needs first
 int init_graphics(const Settings *settings);
 
+// Like init_graphics(), but offscreen: SDL's software renderer draws into a
+// width x height surface. Needs no display or GPU; for benchmarks and image tests.
+int init_graphics_headless(int width, int height);
+
+// Load the remaining fonts. The start screen calls it after its first frame;
+// anything drawing a session calls it first. Returns 0 on success.
+int graphics_load_deferred_fonts(void);
+
 // Show a centered, wrapped message and block until user presses Enter/Esc or closes the window.
 void show_fullscreen_message(const char *text);
 
@@ -23,6 +31,22 @@ void graphics_begin_frame();
 
 void graphics_end_frame();
 
+// Write the frame drawn so far as binary PPM, or BMP when `path` ends in ".bmp".
+// Call before graphics_end_frame(): a window's back buffer is undefined after the
+// present. Returns 0 on success.
+int graphics_capture_frame(const char *path);
+
+// Show or hide the frame-time / render-cost overlay.
+void graphics_toggle_hud(void);
+
+// With --alloc-stats: frames that drew nothing new for a while (steady state), and
+// how many of those still allocated.
+void graphics_alloc_summary(long long *steady, long long *allocating);
+
+// Frames presented so far and their cost (begin to present): median, p99 (to 0.05 ms)
+// and the slowest.
+void graphics_frame_summary(long long *frames, double *p50_ms, double *p99_ms, double *max_ms);
+
 // scrolling ticker state (shared)
 extern int track_scroll;
 extern int track_text_width;
@@ -33,6 +57,9 @@ StartScreenResult get_start_time_from_user(int *hour, int *minute);
 // Draw the shrinking/refilling pie chart based on fraction (0.0 to 1.0)
 void draw_pie(double fraction, TimerType type);
 
+// Draw the spectrum bars around the pie (no-op unless the visualizer is on)
+void draw_visualizer(void);
+
 // Render a digital countdown timer like "25:00"
 void render_countdown(int seconds_left, TimerType type);
 
@@ -0,0 +1,42 @@
+#ifndef LOGGER_H
+#define LOGGER_H
+
+typedef enum {
+    LOG_LEVEL_DEBUG,
+    LOG_LEVEL_INFO,
+    LOG_LEVEL_WARN,
+    LOG_LEVEL_ERROR
+} LogLevel;
+
+// Start the background flusher. Messages below `min_level` are dropped at the call site.
+// If `path` is not NULL, lines are also appended to that file, which is rotated
+// to `path`.1 when it grows past 1 MB. Returns 0 on success.
+// Until this is called (and after logger_shutdown), messages go straight to stderr.
+int logger_init(LogLevel min_level, const char *path);
+
+// Flush everything still queued and stop the flusher. Registered with atexit().
+void logger_shutdown(void);
+
+// Queue a message on the calling thread's ring. Never blocks, never allocates:
+// if the ring is full the message is counted as dropped. Formats on the calling
+// thread, so audio callbacks use log_audio() instead.
+void logger_write(LogLevel level, const char *fmt, ...);
+
+// For SDL_mixer's thread: queues the pointer only, formatting nothing.
+// `msg` must outlive the logger; log_audio() only accepts string literals.
+void logger_write_audio(LogLevel level, const char *msg);
+
+// Give back the ring of the audio thread that was just closed. Call after
+// Mix_CloseAudio(), once that thread has been joined.
+void logger_audio_closed(void);
+
+// Give the calling thread's ring back before the thread exits.
+void logger_thread_exit(void);
+
+#define log_debug(...) logger_write(LOG_LEVEL_DEBUG, __VA_ARGS__)
+#define log_info(...)  logger_write(LOG_LEVEL_INFO,  __VA_ARGS__)
+#define log_warn(...)  logger_write(LOG_LEVEL_WARN,  __VA_ARGS__)
+#define log_error(...) logger_write(LOG_LEVEL_ERROR, __VA_ARGS__)
+#define log_audio(level, msg) logger_write_audio(level, "" msg)
+
+#endif
@@ -0,0 +1,23 @@
+#ifndef LOUDNESS_H
+#define LOUDNESS_H
+
+#include "settings.h"
+
+// Integrated loudness (LUFS, ITU-R BS.1770 K-weighted and gated) and sample peak
+// of 16-bit or float interleaved PCM. Returns 0 on success.
+int loudness_measure(const void *pcm, unsigned int bytes, int freq, int channels,
+                     int is_float, double *lufs, double *peak);
+
+// Measure `paths` one by one on a low-priority background thread.
+// Results are kept in <asset_directory>/cache/loudness.json and reused while
+// the track file is unchanged. Returns 0 if the analysis was started.
+int loudness_start(const Settings *settings, char *const *paths, int count);
+
+// Linear gain that brings track `index` to the target loudness without clipping.
+// 1.0 until the track has been analysed.
+float loudness_gain(int index);
+
+// Cancel the analysis, save what was measured so far and free the table.
+void loudness_stop(void);
+
+#endif
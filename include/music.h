@@ -9,19 +9,82 @@
 const char *get_last_audio_error(void);
 
 // Initialize SDL_mixer and load audio assets.
-// Returns 1 on success, 0 on failure.
+// Returns 1 on success, 0 on failure. Blocks until done; see init_audio_begin().
 int init_audio(const Settings *settings);
 
+typedef enum {
+    AUDIO_INIT_PENDING,
+    AUDIO_INIT_READY,
+    AUDIO_INIT_FAILED       // get_last_audio_error() says why
+} AudioInitStatus;
+
+// Lazy init: starts the music scan on a worker right away and touches no audio
+// device. Can be called before SDL is initialized.
+void init_audio_begin(const Settings *settings);
+
+// Advance the init from the main thread; call when audio is needed. The first call
+// opens the device and hands the alarm decode to a worker, later calls finish once
+// the workers are done.
+AudioInitStatus poll_audio_init(void);
+
+// Device buffer size: large while music plays, small when the alarm is due.
+typedef enum {
+    AUDIO_BUFFER_MUSIC,
+    AUDIO_BUFFER_ALARM
+} AudioBufferMode;
+
+// Switch the device buffer size. Reopens the device, so it is a no-op while
+// anything is playing or a worker holds the device; call again later. Main thread only.
+void set_audio_buffer_mode(AudioBufferMode mode);
+
+// Workers that decode into the device format (Mix_QuerySpec, Mix_LoadWAV) hold the
+// device for that long, so the buffer switch cannot change the format under them.
+void audio_device_hold(void);
+void audio_device_release(void);
+
 // Clean up all audio resources.
 void cleanup_audio(void);
 
-// Start playing a random lo-fi track on loop.
+// Energy benchmark: sample the mixer thread's CPU time on every buffer. Call
+// before the device opens.
+void audio_measure_thread_cpu(void);
+
+// CPU time of the mixer thread(s) so far; 0 unless audio_measure_thread_cpu() was called.
+double audio_thread_cpu_seconds(void);
+
+// Start playing a random lo-fi track on loop, or the selected ambient noise.
+// Like every call below, main thread only.
 void play_lofi(void);
 
-// Stop the currently playing lo-fi track.
+// Apply what SDL_mixer's callbacks reported since the last call (e.g. start the
+// next track when one ends). Call once per frame from the main loop.
+void process_audio_events(void);
+
+// Choose the next lo-fi track: random, not played recently and readable. Records
+// it as current and in the history; play_lofi() uses it. -1 if the library is empty.
+int pick_lofi_track(void);
+
+// Stop the currently playing lo-fi track (or ambient noise).
 void stop_lofi(void);
 
-// Play the alarm sound once.
+// What play_lofi() plays: lo-fi tracks or generated noise.
+typedef enum {
+    AMBIENT_LOFI,
+    AMBIENT_WHITE,
+    AMBIENT_PINK,
+    AMBIENT_BROWN,
+    AMBIENT_RAIN,
+    AMBIENT_COUNT
+} AmbientType;
+
+// Switch to the next ambient source. Noise colours crossfade while playing.
+void cycle_ambient(void);
+
+// The Mix_HookMusic generator behind the noise sources (exposed for benchmarks).
+void ambient_noise_mixer(void *udata, unsigned char *stream, int len);
+
+// Play the alarm sound once. Stops the music; the buffer is switched beforehand
+// (see set_audio_buffer_mode), never here.
 int play_alarm(void);
 int get_alarm_channel(void);
 
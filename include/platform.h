@@ -2,6 +2,7 @@
 #define PLATFORM_H
 
 #include <stddef.h>
+#include <stdint.h>
 
 // Per platform (platform_posix or platform_win).
 // Writes the path to the user's Documents directory into `out`.
@@ -13,6 +14,68 @@ int platform_get_documents_dir(char *out, size_t out_sz);
 // Return 0 on success.
 int platform_mkdir_p(const char *path);
 
+// Per platform (platform_posix or platform_win).
+// Monotonic clock in nanoseconds. Never jumps; stops while the machine is suspended.
+uint64_t platform_monotonic_ns(void);
+
+// Per platform (platform_posix or platform_win).
+// Like platform_monotonic_ns(), but keeps counting through suspend.
+uint64_t platform_boottime_ns(void);
+
+// Per platform (platform_posix or platform_win).
+// Wall clock (UTC) in nanoseconds since the Unix epoch. May jump.
+int64_t platform_wall_ns(void);
+
+// Per platform (platform_posix or platform_win).
+// Sleep until platform_boottime_ns() reaches `deadline_ns`, waking on the deadline
+// itself rather than after a relative delay that can drift.
+void platform_sleep_until_ns(uint64_t deadline_ns);
+
+// Per platform (platform_posix or platform_win).
+// CPU time consumed by the calling thread, in nanoseconds.
+uint64_t platform_thread_cpu_ns(void);
+
+// Resource usage of the whole process so far. Counters a platform cannot
+// measure are -1. `wakeups` only covers threads alive at the time, so two readings
+// compare only when their `wakeup_threads` match.
+typedef struct {
+    double   user_s;                // CPU time in user mode
+    double   system_s;              // CPU time in the kernel
+    int64_t  voluntary_switches;    // context switches because a thread blocked or slept
+    int64_t  involuntary_switches;  // context switches because a thread was preempted
+    int64_t  wakeups;               // times a live thread was put on a CPU (Linux schedstat)
+    uint64_t wakeup_threads;        // identifies the threads `wakeups` was summed over
+    int64_t  peak_rss_kb;           // peak resident set size
+} ProcessUsage;
+
+// Per platform (platform_posix or platform_win).
+// Fill `out` for the calling process. Returns 0 on success.
+int platform_process_usage(ProcessUsage *out);
+
+// Memory held by the process right now. Counters a platform cannot measure are -1.
+typedef struct {
+    int64_t rss_kb;        // resident set size
+    int64_t heap_used_kb;  // handed out by malloc and not yet freed
+    int64_t heap_free_kb;  // kept by malloc but unused: grows with fragmentation
+} MemoryUsage;
+
+// Per platform (platform_posix or platform_win).
+// Fill `out` for the calling process. Returns 0 on success.
+int platform_memory_usage(MemoryUsage *out);
+
+// Per platform (platform_posix or platform_win).
+// Keep the machine awake until platform_release_sleep(), without spawning processes:
+// an IOKit power assertion on macOS, SetThreadExecutionState on Windows and
+// SDL_DisableScreenSaver (the desktop's idle inhibitor) elsewhere. Call from the main
+// thread after the video subsystem is up. Returns 0 on success.
+// Unlike the old `sudo pmset disablesleep`, the macOS assertion does not cover a closed
+// lid: a MacBook still sleeps then, unless it is on power with an external display.
+int platform_inhibit_sleep(const char *reason);
+
+// Per platform (platform_posix or platform_win).
+// Undo platform_inhibit_sleep(). Safe to call when nothing is inhibited.
+void platform_release_sleep(void);
+
 // Returns the platform-specific path separator ('/' on POSIX, '\\' on Windows).
 #if defined(_WIN32)
 #define PLATFORM_PATH_SEP '\\'
@@ -13,17 +13,13 @@ typedef enum {
 // Returns current time in seconds (fractional)
 double get_time_now(void);
 
-// Run a timer until end_time, updating GUI each frame
-// duration_seconds is the total length of the session in seconds
-int run_timer(double      end_time,
-              TimerType   type,
-              int         duration_seconds,
-              int         current_session,
-              const time_t *session_starts,
-              const time_t *session_ends,
-              int         num_sessions);
-
-// Run the full Pomodoro sequence based on settings
+// Run the full Pomodoro sequence based on settings, as a frontend of the timer engine.
+// A start_time in the future is preceded by a break until then.
+// Returns 1 if the user quit prematurely.
 int run_pomodoro(const Settings *settings, time_t start_time);
 
+// End run_pomodoro() (as if the schedule were done) once get_time_now() reaches
+// `end_time`. 0 = no limit. For benchmarks.
+void pomodoro_set_time_limit(double end_time);
+
 #endif
@@ -0,0 +1,41 @@
+#ifndef REPLAY_H
+#define REPLAY_H
+
+#include <SDL.h>
+
+// Input record/replay (--record F, --replay F). The recorder writes every SDL event
+// the app consumes and every clock reading to a compact binary file. Replay feeds
+// them back through a clock of its own and the headless renderer, so a reported
+// slowdown becomes a run that repeats exactly, on any build.
+
+// Start recording to `path`; `width` x `height` is the window size replay will use,
+// and `settings_json` (NULL for none) the settings file the run was started with.
+// Wraps the clock in use, so call it after any virtual clock is installed.
+// Returns 0 on success.
+int replay_record_begin(const char *path, int width, int height, const char *settings_json);
+
+// Read a recording. Call before loading settings: replay runs on the recorded ones.
+// Returns 0 on success.
+int replay_load(const char *path);
+
+// The settings JSON stored in the loaded recording, or NULL when it has none.
+const char *replay_settings(void);
+
+// Install the loaded recording's clock; after any virtual clock, like recording.
+void replay_play_begin(void);
+
+// 1 while a recording is being replayed.
+int replay_playing(void);
+
+// The window size stored in the loaded recording.
+void replay_window_size(int *width, int *height);
+
+// Use instead of SDL_PollEvent() wherever the app consumes input. Records what it
+// returns; when replaying, returns the recorded events once the clock reaches them,
+// then SDL_QUIT when the recording is used up.
+int replay_poll_event(SDL_Event *e);
+
+// At exit: flush the recording, or print the replay's frame costs.
+void replay_finish(void);
+
+#endif
@@ -0,0 +1,56 @@
+#ifndef SCHEDULE_H
+#define SCHEDULE_H
+
+// A compiled schedule: every phase of a study day in a sorted heap array, so the
+// phase for any instant is a binary search away and runtime edits (skip, extend)
+// only shift the phases after the change point. Plain C, no SDL.
+
+typedef enum {
+    TIMER_PHASE_WORK,
+    TIMER_PHASE_BREAK
+} TimerPhaseKind;
+
+// One phase of a schedule, in epoch seconds. Phases are contiguous:
+// each starts where the previous one ends.
+typedef struct {
+    double         start;
+    double         end;
+    TimerPhaseKind kind;
+    int            session;   // work session this phase belongs to, -1 for a lead-in break
+} TimerPhaseSpan;
+
+typedef struct {
+    int work_seconds;
+    int break_seconds;
+    int long_break_seconds;
+    int long_break_every;     // every n-th break is long; 0 = never
+    int sessions;
+} ScheduleSpec;
+
+typedef struct {
+    TimerPhaseSpan *phases;
+    int             count;
+} SchedulePlan;
+
+// Compile `spec` into a plan whose first work session starts at `base`.
+// If lead_in_from < base, a break from lead_in_from to base comes first.
+// Returns NULL on failure.
+SchedulePlan *schedule_plan_create(const ScheduleSpec *spec, double lead_in_from, double base);
+
+void schedule_plan_destroy(SchedulePlan *plan);
+
+// Index of the phase containing `t` (start <= t < end).
+// -1 if t is before the plan, plan->count if at or after its end.
+int schedule_plan_find(const SchedulePlan *plan, double t);
+
+// Move the end of phase `index` to `end` (not before its start) and shift every
+// later phase by the same amount. Returns 0 on success.
+int schedule_plan_set_end(SchedulePlan *plan, int index, double end);
+
+// End phase `index` at `now`, pulling the rest of the plan forward.
+int schedule_plan_skip(SchedulePlan *plan, int index, double now);
+
+// Lengthen phase `index` by `seconds`, pushing the rest of the plan back.
+int schedule_plan_extend(SchedulePlan *plan, int index, double seconds);
+
+#endif
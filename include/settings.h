@@ -22,14 +22,30 @@ typedef struct {
     int work_time;
     int break_time;
     int num_sessions;
+    int long_break_time;    // minutes of every long_break_every-th break
+    int long_break_every;   // 0 = no long breaks
     int width;
     int height;
-    int lid_con;
+    int lid_con;            // 1 = keep the machine awake while the app runs (not with
+                            //     the lid closed on a Mac; see platform_inhibit_sleep)
+    int transcode_cache;   // 1 = keep a pre-decoded copy of the lofi tracks
+    int normalize_loudness; // 1 = play every track at the same loudness
+    int visualizer;         // 1 = spectrum bars around the pie
+    int log_file;           // 1 = also write diagnostics to <asset_directory>/study-with-this.log
     char asset_directory[MAX_PATH_LEN];
     char music_directory[MAX_PATH_LEN];
     char alarm_sound[MAX_PATH_LEN];
+    char ambient[16];       // work-session sound: lofi or a noise colour
+    char alarm_synth[32];   // synthesized alarm preset, empty = use alarm_sound
 } Settings;
 
 Settings load_settings(void);
 
+// The settings file as text (free() it), or NULL when it cannot be read.
+char *read_settings_text(void);
+
+// Fill `out` from settings JSON, as load_settings() does from the file, without
+// touching the disk. Returns 0 on success.
+int parse_settings(const char *text, Settings *out);
+
 #endif
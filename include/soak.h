@@ -0,0 +1,22 @@
+#ifndef SOAK_H
+#define SOAK_H
+
+// Soak test for --soak: while a long (usually simulated) run goes on, keep changing
+// tracks, ringing alarms, pressing the volume, mute, ambient and skip keys and
+// showing the error screen, and sample the process's memory. Memory that keeps
+// growing after the warm-up fails the run (see bench/soak.sh).
+
+// Start driving the session. `samples_path` receives the samples as CSV, or NULL.
+void soak_begin(const char *samples_path);
+
+// From the session loop, once per iteration. No-op unless soak_begin() ran.
+void soak_poll(void);
+
+// 1 between soak_begin() and soak_finish().
+int soak_active(void);
+
+// Take a last sample, write them out and judge them. Returns 1 when RSS or the
+// heap grew steadily, 0 otherwise (also when the run was too short to tell).
+int soak_finish(void);
+
+#endif
@@ -0,0 +1,34 @@
+#ifndef STARTUP_PROFILE_H
+#define STARTUP_PROFILE_H
+
+#include <stdint.h>
+
+#include "alloc_stats.h"
+
+// Startup instrumentation for --profile-startup. Phases are timed on the monotonic
+// clock from main() to the first presented frame, and with --alloc-stats also count
+// the allocations they make. When profiling is off the calls read no clock (unless
+// built with TRACE=1, which traces the phases) and record nothing.
+
+// Where a phase began
+typedef struct {
+    uint64_t    ns;
+    AllocCounts allocs;
+} StartupMark;
+
+// Start profiling; the origin is now. Call first thing in main().
+void startup_profile_enable(void);
+
+int startup_profile_enabled(void);
+
+// Mark to pass to startup_phase_end(), on the same thread.
+StartupMark startup_phase_begin(void);
+
+// Record the phase `name` (a string literal) as running from `begin` until now.
+void startup_phase_end(const char *name, StartupMark begin);
+
+// Called after every present. The first call closes the profile and, when
+// profiling, prints the phase breakdown to stdout.
+void startup_frame_presented(void);
+
+#endif
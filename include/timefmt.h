@@ -0,0 +1,21 @@
+#ifndef TIMEFMT_H
+#define TIMEFMT_H
+
+#include <time.h>
+
+// Local time without localtime() on every frame. The UTC offset is looked up once
+// for the span of time between two DST transitions and cached; within that span a
+// timestamp is split into hours, minutes and seconds with integer arithmetic only.
+// The zone is re-read about once a minute, so a change at runtime shows up.
+
+// Split `t` into local hour, minute and second.
+void timefmt_split(time_t t, int *hour, int *min, int *sec);
+
+// Write `t` as local "HH:MM:SS" (9 bytes with the terminator) into `out`.
+void timefmt_hms(time_t t, char out[9]);
+
+// Drop the cached offsets and re-read the timezone, e.g. after a resume from suspend
+// (the machine may have travelled) or when TZ changed.
+void timefmt_invalidate(void);
+
+#endif
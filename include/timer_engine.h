@@ -0,0 +1,69 @@
+#ifndef TIMER_ENGINE_H
+#define TIMER_ENGINE_H
+
+#include "timing.h"
+#include "schedule.h"
+
+// The session state machine, free of SDL, rendering and audio.
+// It walks a schedule plan against a clock and tells its listeners what happened;
+// frontends (the SDL window, a headless runner, a test harness) only react to events.
+
+typedef enum {
+    TIMER_EVENT_PHASE_START,
+    TIMER_EVENT_TICK,          // once per poll while a phase runs, and once more at its end
+    TIMER_EVENT_PHASE_END,
+    TIMER_EVENT_ALARM,         // right after PHASE_END
+    TIMER_EVENT_DONE           // after the last phase
+} TimerEventType;
+
+typedef struct {
+    TimerEventType        type;
+    int                   phase;      // index into the plan (-1 for DONE)
+    const TimerPhaseSpan *span;       // NULL for DONE
+    double                now;
+    double                remaining;  // seconds left in the phase, >= 0
+    double                fraction;   // share of the phase left, 1 -> 0
+    int                   stale;      // ALARM: the phase ended long ago (e.g. suspend)
+} TimerEvent;
+
+typedef void (*TimerListener)(const TimerEvent *event, void *user);
+
+typedef struct TimerEngine TimerEngine;
+
+#define TIMER_ENGINE_MAX_LISTENERS 4
+
+// Create an engine running `plan`, which the caller keeps and must outlive the engine.
+// `clock` NULL means the timing module's clock. Returns NULL on failure.
+TimerEngine *timer_engine_create(SchedulePlan *plan, const TimingClock *clock);
+
+void timer_engine_destroy(TimerEngine *engine);
+
+// Register a listener. Returns 0 on success.
+int timer_engine_subscribe(TimerEngine *engine, TimerListener listener, void *user);
+
+// Interval between ticks in seconds (default 0.5). Deadlines are aligned to it.
+void timer_engine_set_tick(TimerEngine *engine, double seconds);
+
+// Read the clock, emit whatever events are due and return the time of the next tick.
+// Never blocks, so a frontend can interleave its own event handling.
+double timer_engine_poll(TimerEngine *engine);
+
+// Poll and sleep on the engine's clock until the schedule is done or
+// timer_engine_stop() is called (e.g. from a listener). For headless use.
+void timer_engine_run(TimerEngine *engine);
+
+void timer_engine_stop(TimerEngine *engine);
+
+int timer_engine_done(const TimerEngine *engine);
+
+// Index of the running phase (plan->count when done).
+int timer_engine_current(const TimerEngine *engine);
+
+// End the running phase now; the rest of the plan moves forward.
+// Its PHASE_END and ALARM come with the next poll.
+void timer_engine_skip(TimerEngine *engine);
+
+// Lengthen the running phase by `seconds`; the rest of the plan moves back.
+void timer_engine_extend(TimerEngine *engine, double seconds);
+
+#endif
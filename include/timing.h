@@ -0,0 +1,57 @@
+#ifndef TIMING_H
+#define TIMING_H
+
+// Timing core. Intervals are measured on the boot clock (monotonic, counts through
+// suspend) and anchored to the wall clock, so NTP slews and suspend cannot make the
+// countdown jump or stall. A wall clock that steps away from the anchor (set right
+// after login, an NTP correction) is followed through timing_check_wall().
+
+// Anchor the boot clock to the current wall time. Called lazily by the functions below.
+void timing_init(void);
+
+// Current time in seconds since the Unix epoch: the anchor plus boot-clock time elapsed.
+// Use it for schedules and for display.
+double timing_now(void);
+
+// Seconds the machine spent suspended since the previous call (0 if none).
+double timing_suspend_gap(void);
+
+// Re-anchor to the wall clock, e.g. after the user deliberately set the system time.
+void timing_resync(void);
+
+// Re-anchor if the wall clock moved more than a couple of seconds away from the
+// anchored time. Returns how far it moved (0 if it did not). Cheap enough to call
+// every frame; a no-op under a replacement clock.
+double timing_check_wall(void);
+
+// Sleep until timing_now() reaches `deadline`. Returns immediately if it already has.
+void timing_sleep_until(double deadline);
+
+// Sleep for `seconds` of clock time. Use instead of SDL_Delay so a virtual clock sees it.
+void timing_sleep(double seconds);
+
+// A replacement time source. `now` returns seconds since the epoch; `sleep_until`
+// blocks (or just advances) until `now` reaches the deadline.
+typedef struct {
+    double (*now)(void *ctx);
+    void   (*sleep_until)(void *ctx, double deadline);
+    void   *ctx;
+} TimingClock;
+
+// Route timing_now()/timing_sleep_until() through `clock`. NULL restores the real clock.
+// The clock must outlive its use.
+void timing_set_clock(const TimingClock *clock);
+
+// Built-in virtual clock starting at `start` (epoch seconds).
+// speed > 0 runs it `speed` times faster than real time; speed <= 0 steps it:
+// every sleep jumps straight to its deadline, so a schedule runs as fast as the CPU allows.
+void timing_use_virtual_clock(double start, double speed);
+
+// 1 while a replacement clock is installed.
+int timing_is_virtual(void);
+
+// The clock timing_now() reads: the replacement, or an interface to the real clock.
+// For clocks that wrap another one (input recording).
+const TimingClock *timing_current_clock(void);
+
+#endif
@@ -0,0 +1,68 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <stdint.h>
+
+// Chrome trace (chrome://tracing, ui.perfetto.dev) recording of frames, audio loads
+// and startup. Built only with `make TRACE=1` (-DENABLE_TRACE); otherwise every
+// TRACE_* macro expands to nothing and no trace code runs.
+//
+// Each thread records into its own ring buffer, lock-free, which keeps the newest
+// events; the trace is written as JSON at exit, or on SIGUSR1 (at the next frame)
+// where signals exist.
+
+#ifdef ENABLE_TRACE
+
+// Start recording. Call first thing in main(); registers the exit-time writer.
+void trace_init(void);
+
+// Where trace_write() puts the file. Nothing is written until this is set.
+void trace_set_output(const char *path);
+
+// Name the calling thread in the trace.
+void trace_thread_name(const char *name);
+
+// Call before a traced thread returns: frees its buffer for the next thread, and
+// keeps its events in the trace until that thread claims it.
+void trace_thread_exit(void);
+
+// Begin/end a slice on the calling thread. `name` must be a string literal.
+void trace_begin(const char *name);
+void trace_end(const char *name);
+
+// A slice measured elsewhere, on the platform_monotonic_ns() clock.
+void trace_complete(const char *name, uint64_t begin_ns, uint64_t end_ns);
+
+void trace_counter(const char *name, double value);
+
+// Write the trace now if a signal asked for it. Main thread, once per frame.
+void trace_poll(void);
+
+// Write everything recorded so far to the trace file.
+void trace_write(void);
+
+#define TRACE_INIT()                     trace_init()
+#define TRACE_SET_OUTPUT(path)           trace_set_output(path)
+#define TRACE_THREAD_NAME(name)          trace_thread_name(name)
+#define TRACE_THREAD_EXIT()              trace_thread_exit()
+#define TRACE_BEGIN(name)                trace_begin(name)
+#define TRACE_END(name)                  trace_end(name)
+#define TRACE_COMPLETE(name, begin, end) trace_complete(name, begin, end)
+#define TRACE_COUNTER(name, value)       trace_counter(name, value)
+#define TRACE_POLL()                     trace_poll()
+
+#else
+
+#define TRACE_INIT()                     ((void)0)
+#define TRACE_SET_OUTPUT(path)           ((void)0)
+#define TRACE_THREAD_NAME(name)          ((void)0)
+#define TRACE_THREAD_EXIT()              ((void)0)
+#define TRACE_BEGIN(name)                ((void)0)
+#define TRACE_END(name)                  ((void)0)
+#define TRACE_COMPLETE(name, begin, end) ((void)0)
+#define TRACE_COUNTER(name, value)       ((void)0)
+#define TRACE_POLL()                     ((void)0)
+
+#endif
+
+#endif
@@ -0,0 +1,24 @@
+#ifndef TRANSCODE_H
+#define TRANSCODE_H
+
+#include "settings.h"
+
+// Decode `src` into the opened device's format and write it to `dst` as a PCM WAV,
+// so later playback skips decoding and resampling. SDL_mixer must be open.
+// Returns 0 on success.
+int transcode_file(const char *src, const char *dst);
+
+// Transcode `paths` into <asset_directory>/cache on a small worker pool (two threads,
+// each holding one decoded track).
+// Tracks whose cached copy is newer than the source are not transcoded again.
+// Returns 0 if the job was started.
+int transcode_cache_start(const Settings *settings, char *const *paths, int count);
+
+// Path to load for track `index`: the cached copy when it is up to date,
+// otherwise `original`.
+const char *transcode_cached_path(int index, const char *original);
+
+// Cancel pending work, wait for running jobs and forget the cache table.
+void transcode_cache_stop(void);
+
+#endif
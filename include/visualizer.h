@@ -0,0 +1,30 @@
+#ifndef VISUALIZER_H
+#define VISUALIZER_H
+
+#include <stdbool.h>
+#include <SDL.h>
+
+// Spectrum bars around the pie, fed by the mixer's output.
+// The capture side runs on SDL_mixer's thread and never allocates or locks;
+// it hands samples to the render side through a single-producer/single-consumer ring.
+
+// Precompute the window, twiddles and band edges for the opened device and
+// install the post-mix capture. Returns 0 on success.
+int visualizer_start(void);
+
+// Remove the capture.
+void visualizer_stop(void);
+
+bool visualizer_active(void);
+
+// Mix_SetPostMix callback (exposed for benchmarks).
+void visualizer_capture(void *udata, Uint8 *stream, int len);
+
+// Drain the ring and update the bar levels: window, real FFT, band energies.
+void visualizer_analyse(void);
+
+// Analyse and draw the bars around a circle centred at (cx, cy) in one geometry call.
+// Returns the number of SDL_Render* calls made (0 or 1).
+int visualizer_render(SDL_Renderer *renderer, int cx, int cy, int radius);
+
+#endif
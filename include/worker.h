@@ -0,0 +1,24 @@
+#ifndef WORKER_H
+#define WORKER_H
+
+#include <SDL.h>
+
+// A small pool of SDL threads draining a FIFO of jobs.
+typedef struct WorkerPool WorkerPool;
+
+typedef void (*WorkerJob)(void *arg);
+
+// Spawn `threads` workers (0 = one per CPU core) running at `priority`.
+// Returns NULL on failure.
+WorkerPool *worker_pool_create(int threads, SDL_ThreadPriority priority, const char *name);
+
+// Queue a job. Returns 0 on success.
+int worker_pool_submit(WorkerPool *pool, WorkerJob job, void *arg);
+
+// Block until the queue is empty and no job is running.
+void worker_pool_wait(WorkerPool *pool);
+
+// Drop queued jobs, wait for running ones and join every thread.
+void worker_pool_destroy(WorkerPool *pool);
+
+#endif
@@ -0,0 +1,61 @@
+#include <SDL.h>
+
+#include "alloc_stats.h"
+#include "cJSON.h"
+
+static SDL_malloc_func  real_malloc  = NULL;
+static SDL_calloc_func  real_calloc  = NULL;
+static SDL_realloc_func real_realloc = NULL;
+static SDL_free_func    real_free    = NULL;
+static int              installed    = 0;
+
+// No header in front of the blocks: memory stays interchangeable with free(),
+// so only allocations are counted, not what is live.
+static __thread AllocCounts my_counts;
+
+static void *counted_malloc(size_t size) {
+    my_counts.count++;
+    my_counts.bytes += size;
+    return real_malloc(size);
+}
+
+static void *counted_calloc(size_t nmemb, size_t size) {
+    my_counts.count++;
+    my_counts.bytes += (uint64_t)nmemb * size;
+    return real_calloc(nmemb, size);
+}
+
+static void *counted_realloc(void *mem, size_t size) {
+    my_counts.count++;
+    my_counts.bytes += size;
+    return real_realloc(mem, size);
+}
+
+int alloc_stats_install(void) {
+    if (installed) return 0;
+    if (SDL_GetNumAllocations() > 0) return 1;  // too late: SDL already allocated
+
+    SDL_GetMemoryFunctions(&real_malloc, &real_calloc, &real_realloc, &real_free);
+    if (SDL_SetMemoryFunctions(counted_malloc, counted_calloc, counted_realloc, real_free) != 0) {
+        return 1;
+    }
+
+    // cJSON falls back to malloc + memcpy for reallocations once hooks are set
+    cJSON_Hooks hooks = { counted_malloc, real_free };
+    cJSON_InitHooks(&hooks);
+
+    installed = 1;
+    return 0;
+}
+
+int alloc_stats_installed(void) {
+    return installed;
+}
+
+AllocCounts alloc_stats_thread(void) {
+    return my_counts;
+}
+
+AllocCounts alloc_stats_since(AllocCounts mark) {
+    return (AllocCounts){ my_counts.count - mark.count, my_counts.bytes - mark.bytes };
+}
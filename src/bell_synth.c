@@ -0,0 +1,170 @@
+#include <stdio.h>
+#include <string.h>
+#include <stdbool.h>
+#include <math.h>
+
+#include <SDL.h>
+#include <SDL_mixer.h>
+
+#include "bell_synth.h"
+#include "logger.h"
+
+#define MAX_PARTIALS   8      // one vector's worth of oscillators per lane group
+#define MAX_STRIKES    4
+#define CARRIER_BYTES  4096   // silent loop the effect writes over
+#define OUTPUT_LEVEL   0.7f   // peak of all partials summed
+
+typedef struct {
+    const char *name;
+    float base_hz;
+    int   partials;
+    float ratio[MAX_PARTIALS];  // partial frequency / base
+    float amp[MAX_PARTIALS];    // relative loudness
+    float t60[MAX_PARTIALS];    // seconds until the partial is 60 dB down
+    int   strikes;
+    float interval;             // seconds between strikes
+} BellPreset;
+
+// Partial ratios follow the real instruments: the minor-third "tierce" of a church bell,
+// the stiff-bar modes of a tubular chime, and a slightly detuned pair for a bowl's beating.
+static const BellPreset presets[] = {
+    { "bell",  440.0f, 8,
+      { 0.50f, 1.00f, 1.183f, 1.506f, 2.00f, 2.514f, 2.662f, 3.011f },
+      { 0.50f, 0.80f, 0.60f,  0.30f,  1.00f, 0.35f,  0.25f,  0.20f  },
+      { 5.0f,  3.5f,  3.0f,   2.0f,   2.5f,  1.2f,   1.0f,   0.8f   },
+      2, 1.6f },
+    { "chime", 1046.5f, 4,
+      { 1.00f, 2.756f, 5.404f, 8.933f },
+      { 1.00f, 0.45f,  0.25f,  0.12f  },
+      { 2.5f,  1.4f,   0.7f,   0.4f   },
+      3, 0.45f },
+    { "bowl",  220.0f, 6,
+      { 1.00f, 1.004f, 2.71f, 2.716f, 5.15f, 8.43f },
+      { 1.00f, 0.80f,  0.50f, 0.40f,  0.20f, 0.08f },
+      { 7.0f,  7.0f,   4.5f,  4.5f,   2.0f,  1.0f  },
+      1, 0.0f },
+};
+
+// Oscillator bank state, struct-of-arrays so the per-sample loop over partials vectorises.
+// Each partial is a decaying phasor (re, im) rotated by (cr, ci) every sample.
+typedef struct {
+    float re[MAX_PARTIALS], im[MAX_PARTIALS];
+    float cr[MAX_PARTIALS], ci[MAX_PARTIALS];
+    float amp[MAX_PARTIALS];
+    const BellPreset *preset;
+    long  strike_at[MAX_STRIKES];  // sample index of each strike
+    long  pos;
+    int   channels;
+    SDL_AudioFormat format;
+} BellState;
+
+static Uint8             carrier[CARRIER_BYTES];   // zeros
+static Mix_Chunk        *carrier_chunk = NULL;
+static const BellPreset *active        = NULL;
+static BellState         state;
+static int               synth_channel = -1;
+
+// Helper: excite every partial; adding keeps any ringing from the previous strike
+static void strike(BellState *s) {
+    for (int p = 0; p < MAX_PARTIALS; p++) {
+        s->re[p] += s->amp[p];
+    }
+}
+
+// Mixer effect: overwrite the silent carrier with the oscillator bank output
+static void synth_effect(int chan, void *stream, int len, void *udata) {
+    BellState *s = udata;
+    int frame_bytes = s->channels * SDL_AUDIO_BITSIZE(s->format) / 8;
+    int frames = len / frame_bytes;
+    bool is_float = SDL_AUDIO_ISFLOAT(s->format);
+
+    for (int i = 0; i < frames; i++, s->pos++) {
+        for (int k = 0; k < s->preset->strikes; k++) {
+            if (s->strike_at[k] == s->pos) strike(s);
+        }
+
+        // rotate and damp all phasors at once: no branches, fixed trip count
+        float out = 0.0f;
+        for (int p = 0; p < MAX_PARTIALS; p++) {
+            float re = s->re[p] * s->cr[p] - s->im[p] * s->ci[p];
+            float im = s->re[p] * s->ci[p] + s->im[p] * s->cr[p];
+            s->re[p] = re;
+            s->im[p] = im;
+            out += im;
+        }
+
+        for (int c = 0; c < s->channels; c++) {
+            if (is_float) {
+                ((float *)stream)[i * s->channels + c] = out;
+            } else {
+                ((Sint16 *)stream)[i * s->channels + c] = (Sint16)(out * 32767.0f);
+            }
+        }
+    }
+}
+
+Mix_Chunk *bell_synth_init(const char *preset) {
+    active = NULL;
+    for (size_t i = 0; i < sizeof(presets) / sizeof(presets[0]); i++) {
+        if (strcasecmp(preset, presets[i].name) == 0) {
+            active = &presets[i];
+        }
+    }
+    if (!active) return NULL;
+
+    if (!carrier_chunk) {
+        carrier_chunk = Mix_QuickLoad_RAW(carrier, sizeof(carrier));
+    }
+    return carrier_chunk;
+}
+
+int bell_synth_play(void) {
+    int freq, channels;
+    Uint16 format;
+    if (!active || !carrier_chunk || !Mix_QuerySpec(&freq, &format, &channels)) return -1;
+    if (format != AUDIO_S16SYS && format != AUDIO_F32SYS) return -1;
+
+    float amp_total = 0.0f, longest = 0.0f;
+    for (int p = 0; p < active->partials; p++) {
+        amp_total += active->amp[p];
+        if (active->t60[p] > longest) longest = active->t60[p];
+    }
+
+    // hold the mixer so the effect is in place before the first buffer is mixed
+    Mix_LockAudio();
+    // a second strike while ringing restarts the bell instead of sharing its state
+    if (synth_channel >= 0 && Mix_Playing(synth_channel)) {
+        Mix_HaltChannel(synth_channel);
+    }
+    memset(&state, 0, sizeof(state));
+    state.preset   = active;
+    state.channels = channels;
+    state.format   = format;
+    for (int p = 0; p < active->partials; p++) {
+        double w = 2.0 * M_PI * active->base_hz * active->ratio[p] / freq;
+        double d = pow(10.0, -3.0 / (active->t60[p] * freq));  // -60 dB over t60
+        state.cr[p]  = (float)(d * cos(w));
+        state.ci[p]  = (float)(d * sin(w));
+        state.amp[p] = OUTPUT_LEVEL * active->amp[p] / amp_total;
+    }
+    for (int k = 0; k < active->strikes; k++) {
+        state.strike_at[k] = (long)(k * active->interval * freq);
+    }
+
+    int ms = (int)(((active->strikes - 1) * active->interval + longest) * 1000.0f);
+    int channel = Mix_PlayChannelTimed(-1, carrier_chunk, -1, ms);
+    synth_channel = channel;
+    if (channel >= 0 && !Mix_RegisterEffect(channel, synth_effect, NULL, &state)) {
+        log_error("Mix_RegisterEffect Error: %s", Mix_GetError());
+    }
+    Mix_UnlockAudio();
+    return channel;
+}
+
+void bell_synth_free(void) {
+    if (carrier_chunk) {
+        Mix_FreeChunk(carrier_chunk);  // QuickLoad chunks do not own the buffer
+        carrier_chunk = NULL;
+    }
+    active = NULL;
+}
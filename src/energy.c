@@ -0,0 +1,94 @@
+#include <stdio.h>
+
+#include "energy.h"
+#include "platform.h"
+#include "timing.h"
+#include "music.h"
+#include "logger.h"
+#include "cJSON.h"
+
+#define SECONDS_PER_HOUR 3600.0
+
+static int          started = 0;
+static ProcessUsage start_usage;
+static uint64_t     start_wall_ns;
+static double       start_clock;      // session clock, which may be simulated
+static double       start_audio_cpu;
+
+void energy_begin(void) {
+    if (platform_process_usage(&start_usage) != 0) {
+        log_warn("Energy benchmark: process usage is not available");
+        return;
+    }
+    start_wall_ns   = platform_monotonic_ns();
+    start_clock     = timing_now();
+    start_audio_cpu = audio_thread_cpu_seconds();
+    started = 1;
+}
+
+// Helper: difference of two counters; -1 when the platform has none
+static double counter_delta(int64_t end, int64_t begin) {
+    return (end < 0 || begin < 0) ? -1.0 : (double)(end - begin);
+}
+
+// Helper: `value` per hour of `seconds`; -1 stays -1
+static double per_hour(double value, double seconds) {
+    return (value < 0.0 || seconds <= 0.0) ? -1.0 : value * SECONDS_PER_HOUR / seconds;
+}
+
+int energy_write_report(const char *path) {
+    ProcessUsage end;
+    if (!started || platform_process_usage(&end) != 0) return 1;
+
+    double wall_s      = (platform_monotonic_ns() - start_wall_ns) / 1e9;
+    double simulated_s = timing_now() - start_clock;
+    double cpu_s       = (end.user_s - start_usage.user_s) + (end.system_s - start_usage.system_s);
+    double voluntary   = counter_delta(end.voluntary_switches, start_usage.voluntary_switches);
+    double involuntary = counter_delta(end.involuntary_switches, start_usage.involuntary_switches);
+    double wakeups     = counter_delta(end.wakeups, start_usage.wakeups);
+    if (end.wakeup_threads != start_usage.wakeup_threads && wakeups >= 0.0) {
+        // a thread started or exited in between: its wakeups count on one side only
+        log_warn("Energy benchmark: the set of threads changed, wakeups not reported");
+        wakeups = -1.0;
+    }
+    double audio_cpu_s = audio_thread_cpu_seconds() - start_audio_cpu;
+
+    // flat, one key per line, so shell tools can read it too
+    cJSON *root = cJSON_CreateObject();
+    cJSON_AddNumberToObject(root, "wall_s",               wall_s);
+    cJSON_AddNumberToObject(root, "simulated_s",          simulated_s);
+    cJSON_AddNumberToObject(root, "cpu_user_s",           end.user_s - start_usage.user_s);
+    cJSON_AddNumberToObject(root, "cpu_system_s",         end.system_s - start_usage.system_s);
+    cJSON_AddNumberToObject(root, "voluntary_switches",   voluntary);
+    cJSON_AddNumberToObject(root, "involuntary_switches", involuntary);
+    cJSON_AddNumberToObject(root, "wakeups",              wakeups);
+    cJSON_AddNumberToObject(root, "audio_thread_cpu_s",   audio_cpu_s);
+    cJSON_AddNumberToObject(root, "peak_rss_kb",          (double)end.peak_rss_kb);
+
+    // normalized, for comparing runs of different lengths. The main loop's work
+    // scales with the session clock; the mixer runs in real time.
+    cJSON_AddNumberToObject(root, "cpu_s_per_sim_hour",       per_hour(cpu_s, simulated_s));
+    cJSON_AddNumberToObject(root, "wakeups_per_sim_hour",     per_hour(wakeups, simulated_s));
+    cJSON_AddNumberToObject(root, "switches_per_sim_hour",
+                            per_hour(voluntary < 0.0 ? -1.0 : voluntary + involuntary, simulated_s));
+    cJSON_AddNumberToObject(root, "audio_cpu_s_per_wall_hour", per_hour(audio_cpu_s, wall_s));
+
+    char *json = cJSON_Print(root);
+    cJSON_Delete(root);
+    if (!json) return 1;
+
+    FILE *f = fopen(path, "w");
+    if (!f) {
+        log_error("Energy benchmark: cannot write %s", path);
+        cJSON_free(json);
+        return 1;
+    }
+    fputs(json, f);
+    fputc('\n', f);
+    fclose(f);
+    cJSON_free(json);
+
+    log_info("Energy: %.2f s CPU over %.0f simulated s (%.0f s wall), report in %s",
+             cpu_s, simulated_s, wall_s, path);
+    return 0;
+}
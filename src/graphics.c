@@ -11,9 +11,19 @@
 #include "roboto_font_data.h"
 #include "settings.h"
 #include "music.h"
+#include "visualizer.h"
+#include "logger.h"
+#include "timing.h"
+#include "timefmt.h"
+#include "startup_profile.h"
+#include "platform.h"
+#include "trace.h"
+#include "replay.h"
+#include "alloc_stats.h"
 
 static SDL_Window *window = NULL;
 static SDL_Renderer *renderer = NULL;
+static SDL_Surface *offscreen = NULL;   // headless: the software renderer's target
 static TTF_Font *font_timer = NULL;
 static TTF_Font *font_label = NULL;
 static TTF_Font *font_clock = NULL;
@@ -28,36 +38,349 @@ static int l_panelW = 0;
 static int r_panelW = 0;
 static int status_size = 0;
 
+// point sizes of the fonts loaded after the first frame (graphics_load_deferred_fonts)
+static int  deferred_timer_pt      = 1;
+static int  deferred_clock_pt      = 1;
+static int  deferred_time_table_pt = 1;
+static int  deferred_status_pt     = 1;
+static bool fonts_ready            = false;
+
 int track_scroll = 0;
 int track_text_width = 0;
 
+// Render-cost counters for the HUD. Every SDL_Render*/TTF_Render* call in this file
+// goes through the gfx_* wrappers below, so the numbers are exact.
+typedef struct {
+    int       render_calls;
+    int       textures_created;
+    int       textures_destroyed;
+    int       ttf_calls;
+    long long bytes_uploaded;
+    int       text_misses;     // strings or glyph sets rendered because they were not cached
+    long long allocs;          // heap allocations on this thread (with --alloc-stats)
+    long long alloc_bytes;
+} RenderCounts;
+
+#define HUD_FRAMES 120  // frame times kept for the percentiles
+#define FRAME_BUCKET_MS 0.05  // whole-run frame time histogram, for replays
+#define FRAME_BUCKETS   4000  // up to 200 ms; slower frames land in the last bucket
+
+static RenderCounts frame_counts;           // the frame being drawn
+static RenderCounts last_counts;            // the last presented frame
+static uint64_t     frame_begin_ns = 0;
+static double       frame_ms[HUD_FRAMES];
+static int          frame_ms_next  = 0;
+static int          frame_ms_count = 0;
+static bool         hud_visible    = false;
+static uint64_t     hud_cpu_ns     = 0;     // main thread CPU / wall time when the HUD was shown
+static uint64_t     hud_wall_ns    = 0;
+static uint32_t     frame_hist[FRAME_BUCKETS];
+static long long    frames_total   = 0;
+static double       frame_max_ms   = 0.0;
+
+// Frames well after the last text miss are steady state and should not allocate;
+// with --alloc-stats those that did are counted. The settling frames let SDL's
+// render queue reach its high-water mark after something new was drawn.
+#define STEADY_SETTLE_FRAMES 10
+
+static uint64_t     frame_number      = 0;
+static uint64_t     last_miss_frame   = 0;
+static AllocCounts  frame_alloc_mark;
+static long long    steady_frames     = 0;
+static long long    allocating_frames = 0;
+
+static SDL_Surface *gfx_text(TTF_Font *font, const char *text, SDL_Color color) {
+    frame_counts.ttf_calls++;
+    return TTF_RenderText_Blended(font, text, color);
+}
+
+static SDL_Surface *gfx_text_wrapped(TTF_Font *font, const char *text, SDL_Color color, Uint32 width) {
+    frame_counts.ttf_calls++;
+    return TTF_RenderText_Blended_Wrapped(font, text, color, width);
+}
+
+static SDL_Texture *gfx_texture_from_surface(SDL_Surface *surface) {
+    SDL_Texture *texture = SDL_CreateTextureFromSurface(renderer, surface);
+    if (texture) {
+        frame_counts.textures_created++;
+        frame_counts.bytes_uploaded += (long long)surface->pitch * surface->h;
+    }
+    return texture;
+}
+
+static void gfx_destroy_texture(SDL_Texture *texture) {
+    if (texture) frame_counts.textures_destroyed++;
+    SDL_DestroyTexture(texture);
+}
+
+static int gfx_copy(SDL_Texture *texture, const SDL_Rect *src, const SDL_Rect *dst) {
+    frame_counts.render_calls++;
+    return SDL_RenderCopy(renderer, texture, src, dst);
+}
+
+static int gfx_line(int x1, int y1, int x2, int y2) {
+    frame_counts.render_calls++;
+    return SDL_RenderDrawLine(renderer, x1, y1, x2, y2);
+}
+
+static int gfx_fill_rect(const SDL_Rect *rect) {
+    frame_counts.render_calls++;
+    return SDL_RenderFillRect(renderer, rect);
+}
+
+static int gfx_set_clip(const SDL_Rect *rect) {
+    frame_counts.render_calls++;
+    return SDL_RenderSetClipRect(renderer, rect);
+}
+
+static SDL_Surface *gfx_glyph(TTF_Font *font, Uint16 ch, SDL_Color color) {
+    frame_counts.ttf_calls++;
+    return TTF_RenderGlyph_Blended(font, ch, color);
+}
+
+static Uint32 pack_color(SDL_Color c) {
+    return ((Uint32)c.r << 24) | ((Uint32)c.g << 16) | ((Uint32)c.b << 8) | c.a;
+}
+
+// Text textures kept across frames. A string drawn again in the same font and
+// colour reuses its texture: no TTF call, no upload, no allocation.
+#define TEXT_CACHE_SLOTS 48
+
+typedef struct {
+    TTF_Font    *font;
+    Uint32       color;      // pack_color()
+    char        *text;       // owned; NULL marks a free slot
+    SDL_Texture *texture;
+    int          w, h;
+    uint64_t     last_used;  // frame_number
+} CachedText;
+
+static CachedText text_cache[TEXT_CACHE_SLOTS];
+
+// Helper: the cached texture for `text`, rendered on a miss (evicting the least
+// recently used slot). NULL for an empty string or on error.
+static const CachedText *cached_text(TTF_Font *font, const char *text, SDL_Color color) {
+    if (!font || !text || !text[0]) return NULL;
+
+    Uint32 rgba = pack_color(color);
+    CachedText *victim = &text_cache[0];
+    for (int i = 0; i < TEXT_CACHE_SLOTS; i++) {
+        CachedText *e = &text_cache[i];
+        if (e->text && e->font == font && e->color == rgba && strcmp(e->text, text) == 0) {
+            e->last_used = frame_number;
+            return e;
+        }
+        if (!victim->text) continue;   // already found a free slot
+        if (!e->text || e->last_used < victim->last_used) victim = e;
+    }
+
+    frame_counts.text_misses++;
+    SDL_Surface *sf = gfx_text(font, text, color);
+    if (!sf) return NULL;
+    SDL_Texture *tx = gfx_texture_from_surface(sf);
+    int w = sf->w, h = sf->h;
+    SDL_FreeSurface(sf);
+    char *copy = SDL_strdup(text);
+    if (!tx || !copy) {
+        gfx_destroy_texture(tx);
+        SDL_free(copy);
+        return NULL;
+    }
+
+    if (victim->text) {
+        gfx_destroy_texture(victim->texture);
+        SDL_free(victim->text);
+    }
+    *victim = (CachedText){ font, rgba, copy, tx, w, h, frame_number };
+    return victim;
+}
+
+// Helper: draw a cached string with its top left corner at (x, y)
+static void draw_cached(const CachedText *ct, int x, int y) {
+    if (!ct) return;
+    SDL_Rect dst = { x, y, ct->w, ct->h };
+    gfx_copy(ct->texture, NULL, &dst);
+}
+
+// Glyph atlases for text that changes every second (countdown, clock) or every
+// frame (HUD). Such strings are drawn glyph by glyph from one texture per font
+// and colour, so a new value costs copies rather than a render and an upload.
+#define GLYPH_SETS     6
+#define GLYPH_FIRST    32    // printable ASCII
+#define GLYPH_LAST     126
+#define GLYPH_COUNT    (GLYPH_LAST - GLYPH_FIRST + 1)
+#define DIGITS_CHARSET "0123456789:"
+
+typedef struct {
+    TTF_Font    *font;
+    Uint32       color;
+    SDL_Texture *atlas;
+    int          x[GLYPH_COUNT];  // left edge in the atlas
+    int          w[GLYPH_COUNT];  // advance; 0 = not in the set
+    int          h;
+} GlyphSet;
+
+static GlyphSet glyph_sets[GLYPH_SETS];
+static int      glyph_set_count = 0;
+
+// Helper: the atlas of `charset` (NULL = all printable ASCII) in this font and
+// colour, built on first use. Big fonts should pass DIGITS_CHARSET: a full atlas
+// of a huge font can exceed the renderer's texture size limit.
+static const GlyphSet *glyph_set(TTF_Font *font, SDL_Color color, const char *charset) {
+    if (!font) return NULL;
+    Uint32 rgba = pack_color(color);
+    for (int i = 0; i < glyph_set_count; i++) {
+        if (glyph_sets[i].font == font && glyph_sets[i].color == rgba) return &glyph_sets[i];
+    }
+    if (glyph_set_count == GLYPH_SETS) return NULL;
+
+    frame_counts.text_misses++;
+    GlyphSet *g = &glyph_sets[glyph_set_count];
+    memset(g, 0, sizeof(*g));
+    int total = 0;
+    for (int c = GLYPH_FIRST; c <= GLYPH_LAST; c++) {
+        if (charset && !strchr(charset, c)) continue;
+        char one[2] = { (char)c, '\0' };
+        int w = 0, h = 0;
+        if (TTF_SizeText(font, one, &w, &h) != 0) continue;
+        g->x[c - GLYPH_FIRST] = total;
+        g->w[c - GLYPH_FIRST] = w;
+        total += w;
+    }
+    g->h = TTF_FontHeight(font);
+    if (total <= 0 || g->h <= 0) return NULL;
+
+    SDL_Surface *atlas = SDL_CreateRGBSurfaceWithFormat(0, total, g->h, 32, SDL_PIXELFORMAT_RGBA32);
+    if (!atlas) return NULL;
+    for (int c = GLYPH_FIRST; c <= GLYPH_LAST; c++) {
+        int i = c - GLYPH_FIRST;
+        if (g->w[i] == 0 || c == ' ') continue;
+        SDL_Surface *sf = gfx_glyph(font, (Uint16)c, color);
+        if (!sf) continue;
+        SDL_SetSurfaceBlendMode(sf, SDL_BLENDMODE_NONE);  // copy alpha as is
+        SDL_Rect src = { 0, 0, sf->w < g->w[i] ? sf->w : g->w[i], sf->h < g->h ? sf->h : g->h };
+        SDL_Rect dst = { g->x[i], 0, src.w, src.h };
+        SDL_BlitSurface(sf, &src, atlas, &dst);
+        SDL_FreeSurface(sf);
+    }
+    g->atlas = gfx_texture_from_surface(atlas);
+    SDL_FreeSurface(atlas);
+    if (!g->atlas) return NULL;
+
+    g->font  = font;
+    g->color = rgba;
+    glyph_set_count++;
+    return g;
+}
+
+static int glyph_text_width(const GlyphSet *g, const char *text) {
+    int w = 0;
+    for (const unsigned char *p = (const unsigned char *)text; *p; p++) {
+        if (*p >= GLYPH_FIRST && *p <= GLYPH_LAST) w += g->w[*p - GLYPH_FIRST];
+    }
+    return w;
+}
+
+// Helper: draw `text` from the atlas with its top left corner at (x, y).
+// Characters outside the set are skipped.
+static void draw_glyph_text(const GlyphSet *g, const char *text, int x, int y) {
+    for (const unsigned char *p = (const unsigned char *)text; *p; p++) {
+        if (*p < GLYPH_FIRST || *p > GLYPH_LAST) continue;
+        int i = *p - GLYPH_FIRST;
+        if (g->w[i] == 0) continue;
+        if (*p != ' ') {
+            SDL_Rect src = { g->x[i], 0, g->w[i], g->h };
+            SDL_Rect dst = { x, y, g->w[i], g->h };
+            gfx_copy(g->atlas, &src, &dst);
+        }
+        x += g->w[i];
+    }
+}
+
+// Helper: free every cached string and atlas (the fonts are about to go)
+static void clear_text_caches(void) {
+    for (int i = 0; i < TEXT_CACHE_SLOTS; i++) {
+        if (text_cache[i].text) {
+            SDL_DestroyTexture(text_cache[i].texture);
+            SDL_free(text_cache[i].text);
+        }
+        text_cache[i] = (CachedText){0};
+    }
+    for (int i = 0; i < glyph_set_count; i++) {
+        SDL_DestroyTexture(glyph_sets[i].atlas);
+    }
+    glyph_set_count = 0;
+}
+
 // loading embedded font roboto_font_data.h
 static TTF_Font *load_embedded_font(int pt_size) {
+    StartupMark t = startup_phase_begin();
     SDL_RWops *rw = SDL_RWFromMem(Roboto_Regular_ttf, Roboto_Regular_ttf_len);
     if (!rw) {
-        fprintf(stderr, "SDL_RWFromMem Error: %s\n", SDL_GetError());
+        log_error("SDL_RWFromMem Error: %s", SDL_GetError());
         return NULL;
     }
 
     TTF_Font *font = TTF_OpenFontRW(rw, 1, pt_size);
     if (!font) {
-        fprintf(stderr, "TTF_OpenFontRW Error: %s\n", TTF_GetError());
+        log_error("TTF_OpenFontRW Error: %s", TTF_GetError());
         return NULL;
     }
 
+    startup_phase_end("load_embedded_font", t);
     return font;
 }
 
+// Helper: sizes of padding, pie, fonts and panels from the output size, and the
+// one font the first frame needs
+static int init_layout(void) {
+    // Determine dynamic sizes of padding, pie and font sizes, panel size, based on window height
+    layout_pad      = (int)(layout_winH * 0.10f);
+    layout_pie_size = (int)(layout_winH * 0.50f);
+    l_panelW        = (int)(layout_winW * 0.70f);
+    r_panelW        = layout_winW - layout_pad;
+
+    int areaH = (int)(layout_winW * 0.20f);
+    int timer_size = areaH / 2;
+    if (timer_size < 1) timer_size = 1;
+    int label_size = (int)(timer_size * 0.5f);
+    if (label_size < 1) label_size = 1;
+    int clock_size = (int)(r_panelW * 0.05f);
+    if (clock_size < 1) clock_size = 1;
+    int time_table_size = (int)(r_panelW * 0.03f);
+    if (time_table_size < 1) time_table_size = 1;
+    int status_size = (int)(time_table_size * 0.8f);
+    if (status_size < 1) status_size = 1;
+
+    // only the start screen's prompt font now; the rest once the first frame is up
+    font_label = load_embedded_font(label_size);
+    if (!font_label) {
+        log_error("Font Error: Failed loading one or more fonts.");
+        return 1;
+    }
+    deferred_timer_pt      = timer_size;
+    deferred_clock_pt      = clock_size;
+    deferred_time_table_pt = time_table_size;
+    deferred_status_pt     = status_size;
+    return 0;
+}
+
 int init_graphics(const Settings *settings) {
+    StartupMark t = startup_phase_begin();
     if (SDL_Init(SDL_INIT_VIDEO | SDL_INIT_TIMER) != 0) {
-        fprintf(stderr, "SDL_Init Error: %s\n", SDL_GetError());
+        log_error("SDL_Init Error: %s", SDL_GetError());
         return 1;
     }
+    startup_phase_end("SDL_Init", t);
+
+    t = startup_phase_begin();
     if (TTF_Init() == -1) {
-        fprintf(stderr, "TTF_Init Error: %s\n", TTF_GetError());
+        log_error("TTF_Init Error: %s", TTF_GetError());
         return 1;
     }
+    startup_phase_end("TTF_Init", t);
 
+    t = startup_phase_begin();
     window = SDL_CreateWindow(
         "Study With This",
         SDL_WINDOWPOS_CENTERED,
@@ -67,46 +390,60 @@ int init_graphics(const Settings *settings) {
         SDL_WINDOW_SHOWN
     );
     if (!window) {
-        fprintf(stderr, "Window creation error: %s\n", SDL_GetError());
+        log_error("Window creation error: %s", SDL_GetError());
         return 1;
     }
+    startup_phase_end("SDL_CreateWindow", t);
 
+    t = startup_phase_begin();
     renderer = SDL_CreateRenderer(window, -1, SDL_RENDERER_ACCELERATED);
     if (!renderer) {
-        fprintf(stderr, "Renderer creation error: %s\n", SDL_GetError());
+        log_error("Renderer creation error: %s", SDL_GetError());
         return 1;
     }
+    startup_phase_end("SDL_CreateRenderer", t);
 
-    // Determine dynamic sizes of padding, pie and font sizes, panel size, based on window height
     SDL_GetWindowSize(window, &layout_winW, &layout_winH);
-    layout_pad      = (int)(layout_winH * 0.10f);
-    layout_pie_size = (int)(layout_winH * 0.50f);
-    l_panelW        = (int)(layout_winW * 0.70f);
-    r_panelW        = layout_winW - layout_pad;
+    return init_layout();
+}
 
-    int areaH = (int)(layout_winW * 0.20f);
-    int timer_size = areaH / 2;
-    if (timer_size < 1) timer_size = 1;
-    int label_size = (int)(timer_size * 0.5f);
-    if (label_size < 1) label_size = 1;
-    int clock_size = (int)(r_panelW * 0.05f);
-    if (clock_size < 1) clock_size = 1;
-    int time_table_size = (int)(r_panelW * 0.03f);
-    if (time_table_size < 1) time_table_size = 1;
-    int status_size = (int)(time_table_size * 0.8f);
-    if (status_size < 1) status_size = 1;
+int init_graphics_headless(int width, int height) {
+    // events only: no video driver, display or GPU is needed
+    if (SDL_Init(SDL_INIT_EVENTS | SDL_INIT_TIMER) != 0) {
+        log_error("SDL_Init Error: %s", SDL_GetError());
+        return 1;
+    }
+    if (TTF_Init() == -1) {
+        log_error("TTF_Init Error: %s", TTF_GetError());
+        return 1;
+    }
+
+    offscreen = SDL_CreateRGBSurfaceWithFormat(0, width, height, 32, SDL_PIXELFORMAT_RGBA32);
+    renderer  = offscreen ? SDL_CreateSoftwareRenderer(offscreen) : NULL;
+    if (!renderer) {
+        log_error("Software renderer creation error: %s", SDL_GetError());
+        return 1;
+    }
+
+    layout_winW = width;
+    layout_winH = height;
+    return init_layout();
+}
+
+int graphics_load_deferred_fonts(void) {
+    if (fonts_ready) return 0;
 
     // load the font of different sizes
-    font_timer      = load_embedded_font(timer_size);
-    font_label      = load_embedded_font(label_size);
-    font_clock      = load_embedded_font(clock_size);
-    font_time_table = load_embedded_font(time_table_size);
-    font_status     = load_embedded_font(status_size);
-
-    if (!font_timer || !font_label || !font_clock || !font_time_table || !font_status) {
-        fprintf(stderr, "Font Error: Failed loading one or more fonts.\n");
+    font_timer      = load_embedded_font(deferred_timer_pt);
+    font_clock      = load_embedded_font(deferred_clock_pt);
+    font_time_table = load_embedded_font(deferred_time_table_pt);
+    font_status     = load_embedded_font(deferred_status_pt);
+
+    if (!font_timer || !font_clock || !font_time_table || !font_status) {
+        log_error("Font Error: Failed loading one or more fonts.");
         return 1;
     }
+    fonts_ready = true;
     return 0;
 }
 
@@ -119,13 +456,16 @@ void show_fullscreen_message(const char *text) {
     SDL_Event e;
     int waiting = 1;
 
+    // the message font may still be pending if this is an early error
+    graphics_load_deferred_fonts();
+
     int max_width = layout_winW - 50;
     if (max_width < 50) {
         max_width = layout_winW;  // ultra-defensive fallback
     }
 
     while (waiting) {
-        while (SDL_PollEvent(&e)) {
+        while (replay_poll_event(&e)) {
             if (e.type == SDL_QUIT) {
                 waiting = 0;
             } else if (e.type == SDL_KEYDOWN) {
@@ -143,9 +483,9 @@ void show_fullscreen_message(const char *text) {
         SDL_Color hint_color = (SDL_Color){170, 170, 170, 255};
 
         // Render the main wrapped message
-        SDL_Surface *sf = TTF_RenderText_Blended_Wrapped(font_time_table, text, main_color, max_width);
+        SDL_Surface *sf = gfx_text_wrapped(font_time_table, text, main_color, max_width);
         if (sf) {
-            SDL_Texture *tx = SDL_CreateTextureFromSurface(renderer, sf);
+            SDL_Texture *tx = gfx_texture_from_surface(sf);
             if (tx) {
                 int w = sf->w;
                 int h = sf->h;
@@ -154,17 +494,17 @@ void show_fullscreen_message(const char *text) {
                     (layout_winH - h) / 3,  // roughly 1/3 from top
                     w, h
                 };
-                SDL_RenderCopy(renderer, tx, NULL, &dst);
-                SDL_DestroyTexture(tx);
+                gfx_copy(tx, NULL, &dst);
+                gfx_destroy_texture(tx);
             }
             SDL_FreeSurface(sf);
         }
 
         // Render a hint at the bottom
         const char *hint = "Press Enter to exit.";
-        SDL_Surface *sf_hint = TTF_RenderText_Blended(font_time_table, hint, hint_color);
+        SDL_Surface *sf_hint = gfx_text(font_time_table, hint, hint_color);
         if (sf_hint) {
-            SDL_Texture *tx_hint = SDL_CreateTextureFromSurface(renderer, sf_hint);
+            SDL_Texture *tx_hint = gfx_texture_from_surface(sf_hint);
             if (tx_hint) {
                 int wh = sf_hint->w;
                 int hh = sf_hint->h;
@@ -173,15 +513,15 @@ void show_fullscreen_message(const char *text) {
                     layout_winH - hh - 40,
                     wh, hh
                 };
-                SDL_RenderCopy(renderer, tx_hint, NULL, &dst_hint);
-                SDL_DestroyTexture(tx_hint);
+                gfx_copy(tx_hint, NULL, &dst_hint);
+                gfx_destroy_texture(tx_hint);
             }
             SDL_FreeSurface(sf_hint);
         }
 
         graphics_end_frame();
 
-        SDL_Delay(500);  // 2 FPS, to avoid busy loop
+        SDL_Delay(500);  // 2 FPS, to avoid busy loop; real time, as it waits for a person
     }
 }
 
@@ -194,7 +534,7 @@ StartScreenResult get_start_time_from_user(int *hour, int *minute) {
     SDL_StartTextInput();
 
     while (running) {
-        while (SDL_PollEvent(&e)) {
+        while (replay_poll_event(&e)) {
             if (e.type == SDL_QUIT)
                 return START_SCREEN_QUIT;
             if (e.type == SDL_TEXTINPUT) {
@@ -222,61 +562,182 @@ StartScreenResult get_start_time_from_user(int *hour, int *minute) {
 
         // Draw prompt
         // First, get current time to show with the prompt
-        time_t now = time(NULL);
-        struct tm *local = localtime(&now);
+        int now_h, now_m, now_s;
+        timefmt_split((time_t)timing_now(), &now_h, &now_m, &now_s);
         char now_buf[32];
         snprintf(now_buf, sizeof(now_buf),
-            "(Current time %02d:%02d)", local->tm_hour, local->tm_min);
-
-        SDL_Color color = {255, 255, 255};
-        SDL_Surface *sf1 = TTF_RenderText_Blended(font_label,
-            "Enter the start time (HH:MM)", color);
-        SDL_Texture *tx1 = SDL_CreateTextureFromSurface(renderer, sf1);
-        int w1,h1; SDL_QueryTexture(tx1, NULL,NULL,&w1,&h1);
-        SDL_Rect dst1 = { (layout_winW-w1)/2, layout_winH/3, w1, h1 };
-        SDL_RenderCopy(renderer, tx1, NULL, &dst1);
-        SDL_FreeSurface(sf1);
-        SDL_DestroyTexture(tx1);
-
-        // Render current time
-        SDL_Surface *sf_now = TTF_RenderText_Blended(font_time_table, now_buf, color);
-        SDL_Texture *tx_now = SDL_CreateTextureFromSurface(renderer, sf_now);
-        int wn, hn; SDL_QueryTexture(tx_now, NULL, NULL, &wn, &hn);
-        SDL_Rect dst_now = {
-            (layout_winW - wn)/2,
-            dst1.y + h1 + 5,  // 10px below the prompt
-            wn, hn
-        };
-        SDL_RenderCopy(renderer, tx_now, NULL, &dst_now);
-        SDL_FreeSurface(sf_now);
-        SDL_DestroyTexture(tx_now);
+            "(Current time %02d:%02d)", now_h, now_m);
+
+        SDL_Color color = {255, 255, 255, 255};
+        const CachedText *ct1 = cached_text(font_label, "Enter the start time (HH:MM)", color);
+        int y1 = layout_winH/3, h1 = ct1 ? ct1->h : 0;
+        if (ct1) draw_cached(ct1, (layout_winW - ct1->w)/2, y1);
+
+        // Render current time (from the second frame on, once its font is loaded)
+        if (fonts_ready) {
+            const CachedText *ct_now = cached_text(font_time_table, now_buf, color);
+            if (ct_now) {
+                draw_cached(ct_now, (layout_winW - ct_now->w)/2,
+                            y1 + h1 + 5);  // 10px below the prompt
+            }
+        }
 
         // Draw current input buffer
-        SDL_Surface *sf2 = TTF_RenderText_Blended(font_label, buffer, color);
-        SDL_Texture *tx2 = SDL_CreateTextureFromSurface(renderer, sf2);
-        int w2,h2; SDL_QueryTexture(tx2, NULL,NULL,&w2,&h2);
-        SDL_Rect dst2 = { (layout_winW-w2)/2, layout_winH/2, w2, h2 };
-        SDL_RenderCopy(renderer, tx2, NULL, &dst2);
-        SDL_FreeSurface(sf2);
-        SDL_DestroyTexture(tx2);
+        const CachedText *ct2 = cached_text(font_label, buffer, color);
+        if (ct2) draw_cached(ct2, (layout_winW - ct2->w)/2, layout_winH/2);
 
         graphics_end_frame();
-        SDL_Delay(50);  // 20 fps
+        if (startup_profile_enabled()) {
+            SDL_StopTextInput();
+            return START_SCREEN_QUIT;  // the profile ends at the first frame
+        }
+
+        // finish startup behind the first frame. Audio is none of the start screen's
+        // business: the device opens only when a session begins.
+        if (graphics_load_deferred_fonts() != 0) {
+            SDL_StopTextInput();
+            return START_SCREEN_QUIT;
+        }
+        SDL_Delay(50);  // 20 fps, real time: this waits for a person
     }
     SDL_StopTextInput();
     return 0;
 }
 
+// Helper: for qsort
+static int compare_double(const void *a, const void *b) {
+    double x = *(const double *)a, y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+// Helper: the debug overlay, top left. Counts are those of the previous frame
+// (HUD included); CPU is the main thread's share since the HUD was switched on.
+static void draw_hud(void) {
+    if (!font_status || frame_ms_count == 0) return;
+
+    double sorted[HUD_FRAMES];
+    memcpy(sorted, frame_ms, sizeof(double) * frame_ms_count);
+    qsort(sorted, frame_ms_count, sizeof(double), compare_double);
+    double last = frame_ms[(frame_ms_next + HUD_FRAMES - 1) % HUD_FRAMES];
+    double p50  = sorted[(frame_ms_count - 1) * 50 / 100];
+    double p99  = sorted[(frame_ms_count - 1) * 99 / 100];
+
+    uint64_t cpu  = platform_thread_cpu_ns() - hud_cpu_ns;
+    uint64_t wall = platform_monotonic_ns() - hud_wall_ns;
+
+    char lines[5][96];
+    snprintf(lines[0], sizeof(lines[0]), "frame %.2f ms  p50 %.2f  p99 %.2f  (n=%d)",
+             last, p50, p99, frame_ms_count);
+    snprintf(lines[1], sizeof(lines[1]), "render %d  ttf %d  tex +%d -%d",
+             last_counts.render_calls, last_counts.ttf_calls,
+             last_counts.textures_created, last_counts.textures_destroyed);
+    snprintf(lines[2], sizeof(lines[2]), "upload %.1f KB/frame", last_counts.bytes_uploaded / 1024.0);
+    snprintf(lines[3], sizeof(lines[3]), "main cpu %.2f s  %.1f%%",
+             cpu / 1e9, wall ? 100.0 * cpu / wall : 0.0);
+    if (alloc_stats_installed()) {
+        snprintf(lines[4], sizeof(lines[4]), "alloc %lld (%.1f KB)  text misses %d  allocating %lld/%lld",
+                 last_counts.allocs, last_counts.alloc_bytes / 1024.0, last_counts.text_misses,
+                 allocating_frames, steady_frames);
+    } else {
+        snprintf(lines[4], sizeof(lines[4]), "text misses %d  (--alloc-stats for allocations)",
+                 last_counts.text_misses);
+    }
+
+    // from the glyph atlas, so the overlay itself neither renders text nor allocates
+    SDL_Color hud_color = {0, 255, 0, 255};
+    const GlyphSet *g = glyph_set(font_status, hud_color, NULL);
+    if (!g) return;
+    int y = 4;
+    for (int i = 0; i < 5; i++) {
+        draw_glyph_text(g, lines[i], 4, y);
+        y += g->h;
+    }
+}
+
 void graphics_begin_frame(void) {
+    frame_begin_ns   = platform_monotonic_ns();
+    frame_counts     = (RenderCounts){0};
+    frame_alloc_mark = alloc_stats_thread();
+    frame_number++;
+
     SDL_SetRenderDrawColor(renderer, 0, 0, 0, 255);
+    frame_counts.render_calls++;
     SDL_RenderClear(renderer);
 }
 
 void graphics_end_frame(void) {
+    if (hud_visible) {
+        draw_hud();
+    }
+    frame_counts.render_calls++;
     SDL_RenderPresent(renderer);
+    startup_frame_presented();
+
+    AllocCounts allocs = alloc_stats_since(frame_alloc_mark);
+    frame_counts.allocs      = (long long)allocs.count;
+    frame_counts.alloc_bytes = (long long)allocs.bytes;
+    if (frame_counts.text_misses > 0) {
+        last_miss_frame = frame_number;
+    }
+    if (alloc_stats_installed() && frame_number - last_miss_frame > STEADY_SETTLE_FRAMES) {
+        steady_frames++;
+        if (allocs.count > 0) {
+            if (allocating_frames == 0) {
+                log_warn("Steady-state frame %llu made %llu allocations (%llu bytes)",
+                         (unsigned long long)frame_number,
+                         (unsigned long long)allocs.count, (unsigned long long)allocs.bytes);
+            }
+            allocating_frames++;
+        }
+    }
+    TRACE_COUNTER("frame_allocs", (double)frame_counts.allocs);
+
+    // frame cost: from begin_frame to the end of the present
+    frame_ms[frame_ms_next] = (platform_monotonic_ns() - frame_begin_ns) / 1e6;
+    TRACE_COUNTER("frame_ms", frame_ms[frame_ms_next]);
+    TRACE_COUNTER("render_calls", frame_counts.render_calls);
+    TRACE_POLL();
+
+    int bucket = (int)(frame_ms[frame_ms_next] / FRAME_BUCKET_MS);
+    frame_hist[bucket < FRAME_BUCKETS ? bucket : FRAME_BUCKETS - 1]++;
+    if (frame_ms[frame_ms_next] > frame_max_ms) frame_max_ms = frame_ms[frame_ms_next];
+    frames_total++;
+
+    frame_ms_next = (frame_ms_next + 1) % HUD_FRAMES;
+    if (frame_ms_count < HUD_FRAMES) frame_ms_count++;
+    last_counts = frame_counts;
+}
+
+void graphics_alloc_summary(long long *steady, long long *allocating) {
+    *steady     = steady_frames;
+    *allocating = allocating_frames;
+}
+
+// Helper: upper edge of the bucket holding the frame at `permille` of the run
+static double frame_percentile(int permille) {
+    long long rank = (frames_total - 1) * permille / 1000, seen = 0;
+    for (int i = 0; i < FRAME_BUCKETS; i++) {
+        seen += frame_hist[i];
+        if (seen > rank) return (i + 1) * FRAME_BUCKET_MS;
+    }
+    return frame_max_ms;
+}
+
+void graphics_frame_summary(long long *frames, double *p50_ms, double *p99_ms, double *max_ms) {
+    *frames = frames_total;
+    *p50_ms = frames_total ? frame_percentile(500) : 0.0;
+    *p99_ms = frames_total ? frame_percentile(990) : 0.0;
+    *max_ms = frame_max_ms;
+}
+
+void graphics_toggle_hud(void) {
+    hud_visible = !hud_visible;
+    hud_cpu_ns  = platform_thread_cpu_ns();
+    hud_wall_ns = platform_monotonic_ns();
 }
 
 void draw_pie(double fraction, TimerType type) {
+    TRACE_BEGIN("draw_pie");
     int radius = layout_pie_size / 2;
     int cx = l_panelW / 2;
     int cy = layout_pad + radius;
@@ -289,7 +750,7 @@ void draw_pie(double fraction, TimerType type) {
             double angle = 2.0 * M_PI * i / segments;
             int x = cx + (int)(sin(angle) * radius);
             int y = cy - (int)(cos(angle) * radius);
-            SDL_RenderDrawLine(renderer, cx, cy, x, y);
+            gfx_line(cx, cy, x, y);
         }
         // Black wedge clockwise
         int black_segs = (int)((1.0 - fraction) * segments);
@@ -298,7 +759,7 @@ void draw_pie(double fraction, TimerType type) {
             double angle = 2.0 * M_PI * i / segments;
             int x = cx + (int)(sin(angle) * radius);
             int y = cy - (int)(cos(angle) * radius);
-            SDL_RenderDrawLine(renderer, cx, cy, x, y);
+            gfx_line(cx, cy, x, y);
         }
     } else {
         // Break time: black background then red refill CCW
@@ -308,9 +769,15 @@ void draw_pie(double fraction, TimerType type) {
             double angle = -2.0 * M_PI * i / segments;
             int x = cx + (int)(sin(angle) * radius);
             int y = cy - (int)(cos(angle) * radius);
-            SDL_RenderDrawLine(renderer, cx, cy, x, y);
+            gfx_line(cx, cy, x, y);
         }
     }
+    TRACE_END("draw_pie");
+}
+
+void draw_visualizer(void) {
+    int radius = layout_pie_size / 2;
+    frame_counts.render_calls += visualizer_render(renderer, l_panelW / 2, layout_pad + radius, radius);
 }
 
 void render_countdown(int seconds_left, TimerType type) {
@@ -324,28 +791,20 @@ void render_countdown(int seconds_left, TimerType type) {
 
     // Label using font_label
     const char *label = (type == WORK) ? "STUDY TIME" : "BREAK TIME";
-    SDL_Surface *surfLabel = TTF_RenderText_Blended(font_label, label, color);
-    SDL_Texture *texLabel = SDL_CreateTextureFromSurface(renderer, surfLabel);
-    int wL, hL;
-    SDL_QueryTexture(texLabel, NULL, NULL, &wL, &hL);
-    SDL_Rect dstL = { cx - wL / 2, labelY + (areaH - hL) / 4, wL, hL };
-    SDL_RenderCopy(renderer, texLabel, NULL, &dstL);
-    SDL_FreeSurface(surfLabel);
-    SDL_DestroyTexture(texLabel);
-
-    // Countdown using font_timer
+    const CachedText *ctL = cached_text(font_label, label, color);
+    int hL = ctL ? ctL->h : 0;
+    if (ctL) draw_cached(ctL, cx - ctL->w / 2, labelY + (areaH - hL) / 4);
+
+    // Countdown using font_timer, from its digit atlas
     int mins = seconds_left / 60;
     int secs = seconds_left % 60;
     char buf[16];
     snprintf(buf, sizeof(buf), "%02d:%02d", mins, secs);
-    SDL_Surface *surfCnt = TTF_RenderText_Blended(font_timer, buf, color);
-    SDL_Texture *texCnt = SDL_CreateTextureFromSurface(renderer, surfCnt);
-    int wC, hC;
-    SDL_QueryTexture(texCnt, NULL, NULL, &wC, &hC);
-    SDL_Rect dstC = { cx - wC / 2, labelY + (areaH - hL) / 4 + hL + (areaH - hL - hC) / 4, wC, hC };
-    SDL_RenderCopy(renderer, texCnt, NULL, &dstC);
-    SDL_FreeSurface(surfCnt);
-    SDL_DestroyTexture(texCnt);
+    const GlyphSet *g = glyph_set(font_timer, color, DIGITS_CHARSET);
+    if (g) {
+        int wC = glyph_text_width(g, buf);
+        draw_glyph_text(g, buf, cx - wC / 2, labelY + (areaH - hL) / 4 + hL + (areaH - hL - g->h) / 4);
+    }
 }
 
 void draw_panel(time_t now,
@@ -354,6 +813,8 @@ void draw_panel(time_t now,
                 const time_t *session_ends,
                 int num_sessions)
 {
+    TRACE_BEGIN("draw_panel");
+
     // 1) Panel metrics
     int pad        = layout_pad;                    // cached in init
     int winW       = layout_winW,
@@ -371,50 +832,32 @@ void draw_panel(time_t now,
 
     // For current music ticker boundary
     SDL_Rect clip = { panelX, panelY, panelW, panelH };
-    SDL_RenderSetClipRect(renderer, &clip);
+    gfx_set_clip(&clip);
 
-    int wl, hl, wc, hc;  // width and height of 'local time' label to be referred elsewhere
+    int wl = 0, hl = 0, wc = 0, hc = 0;  // width and height of 'local time' label to be referred elsewhere
 
     // 2) Draw "Local time" label
     {
-        SDL_Surface *sfl = TTF_RenderText_Blended(font_clock,
-                                                 "Local time",
-                                                 white);
-        SDL_Texture *txl = SDL_CreateTextureFromSurface(renderer, sfl);
-        SDL_QueryTexture(txl, NULL, NULL, &wl, &hl);
-
-        // center that label in the panel top
-        SDL_Rect dstl = {
-            panelX + (panelW - wl)/2,
-            pad,
-            wl, hl
-        };
-        SDL_RenderCopy(renderer, txl, NULL, &dstl);
-
-        SDL_FreeSurface(sfl);
-        SDL_DestroyTexture(txl);
+        const CachedText *ctl = cached_text(font_clock, "Local time", white);
+        if (ctl) {
+            wl = ctl->w;
+            hl = ctl->h;
+            // center that label in the panel top
+            draw_cached(ctl, panelX + (panelW - wl)/2, pad);
+        }
     }
 
-    // And under "Local Time", draw a digital clock
+    // And under "Local Time", draw a digital clock, from the digit atlas
     {
-        struct tm *lt = localtime(&now);
         char timestr[16];
-        snprintf(timestr,sizeof(timestr), "%02d:%02d:%02d",
-                 lt->tm_hour, lt->tm_min, lt->tm_sec);
+        timefmt_hms(now, timestr);
 
-        SDL_Surface *sf = TTF_RenderText_Blended(font_clock, timestr, white);
-        SDL_Texture *tx = SDL_CreateTextureFromSurface(renderer, sf);
-        SDL_QueryTexture(tx, NULL,NULL,&wc,&hc);
-
-        SDL_Rect dst = {
-            panelX + (panelW - wc)/2,
-            hl + 5 + pad,
-            wc, hc
-        };
-        SDL_RenderCopy(renderer, tx, NULL, &dst);
-
-        SDL_FreeSurface(sf);
-        SDL_DestroyTexture(tx);
+        const GlyphSet *g = glyph_set(font_clock, white, DIGITS_CHARSET);
+        if (g) {
+            wc = glyph_text_width(g, timestr);
+            hc = g->h;
+            draw_glyph_text(g, timestr, panelX + (panelW - wc)/2, hl + 5 + pad);
+        }
     }
 
     // 3) Draw the work-session timetable
@@ -422,21 +865,20 @@ void draw_panel(time_t now,
     for (int i = 0; i < num_sessions; i++) {
         // Format: "i   HH:MM - HH:MM"
         char buf[64];
-        struct tm st_tm = *localtime(&session_starts[i]);
-        struct tm et_tm = *localtime(&session_ends[i]);
+        int sh, sm, eh, em, unused;
+        timefmt_split(session_starts[i], &sh, &sm, &unused);
+        timefmt_split(session_ends[i], &eh, &em, &unused);
 
         snprintf(buf, sizeof(buf),
                  "%d   %02d:%02d - %02d:%02d",
-                 i+1,
-                 st_tm.tm_hour, st_tm.tm_min,
-                 et_tm.tm_hour, et_tm.tm_min);
+                 i+1, sh, sm, eh, em);
 
-        // Render text surface
-        SDL_Surface *sf = TTF_RenderText_Blended(font_time_table,
-                                buf,
-                                (i == current_session) ? highlightFg : white);
-        SDL_Texture *tx = SDL_CreateTextureFromSurface(renderer, sf);
-        int w,h; SDL_QueryTexture(tx, NULL,NULL,&w,&h);
+        // Render text (cached: rows only change when the schedule does)
+        const CachedText *ct = cached_text(font_time_table,
+                                           buf,
+                                           (i == current_session) ? highlightFg : white);
+        if (!ct) continue;
+        int w = ct->w, h = ct->h;
 
         // Optionally draw highlight background
         if (i == current_session) {
@@ -446,19 +888,11 @@ void draw_panel(time_t now,
                                    highlightBg.b,
                                    highlightBg.a);
             SDL_Rect bg = { panelX, y, panelW, h };
-            SDL_RenderFillRect(renderer, &bg);
+            gfx_fill_rect(&bg);
         }
 
         // Draw text
-        SDL_Rect dst = {
-            panelX + (panelW - w)/2,
-            y,
-            w, h
-        };
-        SDL_RenderCopy(renderer, tx, NULL, &dst);
-
-        SDL_FreeSurface(sf);
-        SDL_DestroyTexture(tx);
+        draw_cached(ct, panelX + (panelW - w)/2, y);
 
         y += h + 5;  // 5px line spacing
         if (y > panelY + panelH - h) break;
@@ -481,29 +915,21 @@ void draw_panel(time_t now,
     snprintf(volbuf, sizeof(volbuf),
              "Vol: %d%%",
              get_volume_percent());
-    SDL_Surface *sf_vol = TTF_RenderText_Blended(font_status, volbuf, status_color);
-    SDL_Texture *tx_vol = SDL_CreateTextureFromSurface(renderer, sf_vol);
-    int wv,hv; SDL_QueryTexture(tx_vol, NULL,NULL,&wv,&hv);
-    SDL_Rect dst_vol = {sx, sy, wv, hv};
-    SDL_RenderCopy(renderer, tx_vol, NULL, &dst_vol);
-    SDL_FreeSurface(sf_vol); SDL_DestroyTexture(tx_vol);
+    const CachedText *ct_vol = cached_text(font_status, volbuf, status_color);
+    int hv = ct_vol ? ct_vol->h : 0;
+    draw_cached(ct_vol, sx, sy);
 
     // 2) Keys reminder
-    const char *keys = "M mute [ ] vol up/down";
-    SDL_Surface *sf_keys = TTF_RenderText_Blended(font_status, keys, status_color);
-    SDL_Texture *tx_keys = SDL_CreateTextureFromSurface(renderer, sf_keys);
-    int wk,hk; SDL_QueryTexture(tx_keys, NULL,NULL,&wk,&hk);
-    SDL_Rect dst_keys = { sx, sy + hv + spacing, wk, hk };
-    SDL_RenderCopy(renderer, tx_keys, NULL, &dst_keys);
-    SDL_FreeSurface(sf_keys); SDL_DestroyTexture(tx_keys);
+    const char *keys = "M mute [ ] vol N sound S skip E +5m";
+    const CachedText *ct_keys = cached_text(font_status, keys, status_color);
+    int hk = ct_keys ? ct_keys->h : 0;
+    draw_cached(ct_keys, sx, sy + hv + spacing);
 
     // 3) Current track
     const char *track = get_current_lofi_name();
-    SDL_Surface *sf_track = TTF_RenderText_Blended(font_status, track, status_color);
-    SDL_Texture *tx_track = SDL_CreateTextureFromSurface(renderer, sf_track);
+    const CachedText *ct_track = cached_text(font_status, track, status_color);
 
-    int wt,ht;
-    SDL_QueryTexture(tx_track, NULL, NULL, &track_text_width, &ht);
+    track_text_width = ct_track ? ct_track->w : 0;
 
     int panelLeft   = panelX;
     int panelRight  = panelX + panelW;
@@ -519,26 +945,62 @@ void draw_panel(time_t now,
     }
 
     // actually drawing the current track
-    SDL_Rect dst_track = { drawX, sy + hv + spacing + hk + spacing, track_text_width, ht };
-    SDL_RenderCopy(renderer, tx_track, NULL, &dst_track);
-    SDL_RenderSetClipRect(renderer, NULL);
-
-    SDL_FreeSurface(sf_track); SDL_DestroyTexture(tx_track);  // clean up
+    draw_cached(ct_track, drawX, sy + hv + spacing + hk + spacing);
+    gfx_set_clip(NULL);
+    TRACE_END("draw_panel");
 }
 
 void cleanup_graphics(void) {
+    clear_text_caches();
     if (font_timer)  TTF_CloseFont(font_timer);
     if (font_label)  TTF_CloseFont(font_label);
     if (font_clock) TTF_CloseFont(font_clock);
     if (font_time_table) TTF_CloseFont(font_time_table);
     if (font_status) TTF_CloseFont(font_status);
+    font_timer = font_label = font_clock = font_time_table = font_status = NULL;
+    fonts_ready = false;
 
     if (renderer) SDL_DestroyRenderer(renderer);
     if (window) SDL_DestroyWindow(window);
+    if (offscreen) SDL_FreeSurface(offscreen);
+    renderer  = NULL;
+    window    = NULL;
+    offscreen = NULL;   // init_graphics*() may run again (benchmarks)
     TTF_Quit();
     SDL_Quit();
 }
 
+// Helper: binary PPM (P6) from tightly packed RGB24 rows
+static int write_ppm(const char *path, const Uint8 *rgb, int w, int h, int pitch) {
+    FILE *f = fopen(path, "wb");
+    if (!f) return 1;
+    fprintf(f, "P6\n%d %d\n255\n", w, h);
+    for (int y = 0; y < h; y++) {
+        fwrite(rgb + (size_t)y * pitch, 3, (size_t)w, f);
+    }
+    return fclose(f) != 0;
+}
+
+int graphics_capture_frame(const char *path) {
+    int w, h;
+    if (SDL_GetRendererOutputSize(renderer, &w, &h) != 0) return 1;
+
+    SDL_Surface *shot = SDL_CreateRGBSurfaceWithFormat(0, w, h, 24, SDL_PIXELFORMAT_RGB24);
+    if (!shot) return 1;
+    int rc = SDL_RenderReadPixels(renderer, NULL, SDL_PIXELFORMAT_RGB24, shot->pixels, shot->pitch);
+    if (rc == 0) {
+        size_t len = strlen(path);
+        rc = (len > 4 && strcmp(path + len - 4, ".bmp") == 0)
+            ? SDL_SaveBMP(shot, path)
+            : write_ppm(path, shot->pixels, w, h, shot->pitch);
+    }
+    if (rc != 0) {
+        log_error("Could not capture the frame to %s: %s", path, SDL_GetError());
+    }
+    SDL_FreeSurface(shot);
+    return rc != 0;
+}
+
 SDL_Renderer* get_renderer(void) {
     return renderer;
 }
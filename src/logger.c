@@ -0,0 +1,258 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include <stdbool.h>
+
+#include <SDL.h>
+
+#include "logger.h"
+
+#define MAX_LOG_THREADS  32      // rings; messages from threads beyond this are counted as dropped
+#define RING_ENTRIES     64      // power of two
+#define MSG_LEN          152
+#define FLUSH_MS         50
+#define ROTATE_BYTES     (1024 * 1024)
+
+typedef struct {
+    Uint64   ticks;
+    LogLevel level;
+    const char *text;       // constant message from the audio thread, or NULL for msg
+    char     msg[MSG_LEN];
+} LogEntry;
+
+// Single-producer (the owning thread) / single-consumer (the flusher) ring.
+typedef struct {
+    SDL_atomic_t owned;
+    SDL_atomic_t head;      // written by the owner
+    SDL_atomic_t tail;      // written by the flusher
+    LogEntry     entries[RING_ENTRIES];
+} LogRing;
+
+static LogRing       rings[MAX_LOG_THREADS];
+static __thread LogRing *my_ring = NULL;
+static LogRing      *audio_ring = NULL;     // claimed by the current audio thread
+static SDL_atomic_t  running;
+static SDL_atomic_t  dropped;
+static int           min_level = LOG_LEVEL_INFO;
+static Uint64        start_ticks = 0;
+static SDL_Thread   *flusher = NULL;
+static SDL_sem      *wake = NULL;
+static FILE         *log_file = NULL;
+static char          log_path[1024];
+static long          log_bytes = 0;
+
+static const char *level_names[] = { "DEBUG", "INFO", "WARN", "ERROR" };
+
+// Helper: seconds since logger_init, for the line prefix
+static double elapsed(Uint64 ticks) {
+    return (double)(ticks - start_ticks) / SDL_GetPerformanceFrequency();
+}
+
+// Helper: move log_path to log_path.1 and start a fresh file
+static void rotate_file(void) {
+    char old[sizeof(log_path) + 2];
+    snprintf(old, sizeof(old), "%s.1", log_path);
+    fclose(log_file);
+    remove(old);
+    rename(log_path, old);
+    log_file  = fopen(log_path, "a");
+    log_bytes = 0;
+}
+
+static void emit(const LogEntry *e) {
+    const char *msg = e->text ? e->text : e->msg;
+    fprintf(stderr, "[%9.3f] %-5s %s\n", elapsed(e->ticks), level_names[e->level], msg);
+    if (log_file) {
+        int n = fprintf(log_file, "[%9.3f] %-5s %s\n", elapsed(e->ticks), level_names[e->level], msg);
+        if (n > 0) log_bytes += n;
+        if (log_bytes > ROTATE_BYTES) rotate_file();
+    }
+}
+
+static int compare_entries(const void *a, const void *b) {
+    const LogEntry *x = a, *y = b;
+    return (x->ticks > y->ticks) - (x->ticks < y->ticks);
+}
+
+// Drain every ring, merge by timestamp and write
+static void flush_rings(void) {
+    static LogEntry batch[MAX_LOG_THREADS * RING_ENTRIES];
+    int n = 0;
+
+    for (int r = 0; r < MAX_LOG_THREADS; r++) {
+        LogRing *ring = &rings[r];
+        int head = SDL_AtomicGet(&ring->head);
+        SDL_MemoryBarrierAcquire();
+        int tail = SDL_AtomicGet(&ring->tail);
+        while (tail != head) {
+            batch[n++] = ring->entries[tail];
+            tail = (tail + 1) & (RING_ENTRIES - 1);
+        }
+        SDL_AtomicSet(&ring->tail, tail);
+    }
+    if (n == 0 && SDL_AtomicGet(&dropped) == 0) return;
+
+    qsort(batch, n, sizeof(LogEntry), compare_entries);
+    for (int i = 0; i < n; i++) emit(&batch[i]);
+
+    int lost = SDL_AtomicSet(&dropped, 0);
+    if (lost > 0) {
+        LogEntry note = { SDL_GetPerformanceCounter(), LOG_LEVEL_WARN, NULL, "" };
+        snprintf(note.msg, sizeof(note.msg), "%d log messages dropped (ring full)", lost);
+        emit(&note);
+    }
+    if (log_file) fflush(log_file);
+}
+
+static int flusher_main(void *data) {
+    (void)data;
+    while (SDL_AtomicGet(&running)) {
+        SDL_SemWaitTimeout(wake, FLUSH_MS);
+        flush_rings();
+    }
+    flush_rings();
+    return 0;
+}
+
+// Helper: claim a ring for the calling thread
+static LogRing *claim_ring(void) {
+    for (int r = 0; r < MAX_LOG_THREADS; r++) {
+        if (SDL_AtomicCAS(&rings[r].owned, 0, 1)) return &rings[r];
+    }
+    return NULL;
+}
+
+// Helper: the slot the calling thread writes next, or NULL (counted as dropped)
+static LogEntry *next_entry(LogLevel level) {
+    if (!my_ring) my_ring = claim_ring();
+    if (!my_ring) {
+        SDL_AtomicAdd(&dropped, 1);
+        return NULL;
+    }
+
+    int head = SDL_AtomicGet(&my_ring->head);
+    int next = (head + 1) & (RING_ENTRIES - 1);
+    if (next == SDL_AtomicGet(&my_ring->tail)) {
+        SDL_AtomicAdd(&dropped, 1);   // full: drop rather than wait for the flusher
+        return NULL;
+    }
+
+    LogEntry *e = &my_ring->entries[head];
+    e->ticks = SDL_GetPerformanceCounter();
+    e->level = level;
+    e->text  = NULL;
+    return e;
+}
+
+// Helper: hand the entry from next_entry to the flusher
+static void publish_entry(void) {
+    SDL_MemoryBarrierRelease();
+    SDL_AtomicSet(&my_ring->head, (SDL_AtomicGet(&my_ring->head) + 1) & (RING_ENTRIES - 1));
+}
+
+// Helper: wait for the flusher to drain `ring`, then free it for another thread
+static void release_ring(LogRing *ring) {
+    while (SDL_AtomicGet(&running) &&
+           SDL_AtomicGet(&ring->head) != SDL_AtomicGet(&ring->tail)) {
+        SDL_SemPost(wake);
+        SDL_Delay(1);
+    }
+    SDL_AtomicSet(&ring->owned, 0);
+}
+
+int logger_init(LogLevel level, const char *path) {
+    if (SDL_AtomicGet(&running)) return 0;
+
+    min_level   = level;
+    start_ticks = SDL_GetPerformanceCounter();
+    if (path && path[0]) {
+        snprintf(log_path, sizeof(log_path), "%s", path);
+        log_file = fopen(log_path, "a");
+        if (!log_file) {
+            fprintf(stderr, "Could not open log file: %s\n", log_path);
+        } else {
+            fseek(log_file, 0, SEEK_END);
+            log_bytes = ftell(log_file);
+        }
+    }
+
+    wake = SDL_CreateSemaphore(0);
+    SDL_AtomicSet(&running, 1);
+    flusher = wake ? SDL_CreateThread(flusher_main, "logger", NULL) : NULL;
+    if (!flusher) {
+        SDL_AtomicSet(&running, 0);
+        fprintf(stderr, "Logger thread failed to start: %s\n", SDL_GetError());
+        return -1;
+    }
+    atexit(logger_shutdown);
+    return 0;
+}
+
+void logger_shutdown(void) {
+    if (!SDL_AtomicGet(&running)) return;
+    SDL_AtomicSet(&running, 0);
+    SDL_SemPost(wake);
+    SDL_WaitThread(flusher, NULL);
+    flusher = NULL;
+    SDL_DestroySemaphore(wake);
+    wake = NULL;
+    if (log_file) {
+        fclose(log_file);
+        log_file = NULL;
+    }
+}
+
+void logger_write(LogLevel level, const char *fmt, ...) {
+    if ((int)level < min_level) return;
+
+    va_list args;
+    va_start(args, fmt);
+
+    if (!SDL_AtomicGet(&running)) {
+        // not started (or already stopped): plain synchronous stderr
+        fprintf(stderr, "%-5s ", level_names[level]);
+        vfprintf(stderr, fmt, args);
+        fputc('\n', stderr);
+        va_end(args);
+        return;
+    }
+
+    LogEntry *e = next_entry(level);
+    if (e) {
+        vsnprintf(e->msg, sizeof(e->msg), fmt, args);
+        publish_entry();
+    }
+    va_end(args);
+}
+
+void logger_write_audio(LogLevel level, const char *msg) {
+    if ((int)level < min_level) return;
+
+    if (!SDL_AtomicGet(&running)) {
+        fprintf(stderr, "%-5s %s\n", level_names[level], msg);
+        return;
+    }
+
+    // the audio thread never calls logger_thread_exit; remember its ring for the close path
+    bool claimed = (my_ring == NULL);
+    LogEntry *e = next_entry(level);
+    if (claimed && my_ring) audio_ring = my_ring;
+    if (e) {
+        e->text = msg;
+        publish_entry();
+    }
+}
+
+void logger_audio_closed(void) {
+    if (!audio_ring) return;
+    release_ring(audio_ring);
+    audio_ring = NULL;
+}
+
+void logger_thread_exit(void) {
+    if (!my_ring) return;
+    // let the flusher drain what this thread queued before handing the ring on
+    release_ring(my_ring);
+    my_ring = NULL;
+}
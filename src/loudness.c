@@ -0,0 +1,333 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <sys/stat.h>
+
+#include <SDL.h>
+#include <SDL_mixer.h>
+
+#include "loudness.h"
+#include "cJSON.h"
+#include "platform.h"
+#include "transcode.h"
+#include "music.h"
+#include "worker.h"
+#include "logger.h"
+
+#define TARGET_LUFS      -16.0   // loudness every track is brought to
+#define PEAK_CEILING      0.89   // -1 dBFS: never push a peak past this
+#define MAX_BOOST_DB      12.0
+#define MAX_CUT_DB       -24.0
+#define BLOCK_FRAMES     256     // frames converted to float per kernel call
+#define ABSOLUTE_GATE    -70.0   // LUFS
+#define RELATIVE_GATE    -10.0   // LU below the ungated mean
+
+typedef struct {
+    char         path[MAX_PATH_LEN];
+    long long    mtime;
+    double       lufs;
+    double       peak;
+    float        gain;
+    SDL_atomic_t ready;
+} TrackLoudness;
+
+static WorkerPool    *pool        = NULL;
+static TrackLoudness *tracks      = NULL;
+static int            track_count = 0;
+static char           cache_path[MAX_PATH_LEN];
+static SDL_atomic_t   cancelled;
+
+// One biquad stage per channel, Direct Form II transposed.
+typedef struct {
+    double b0, b1, b2, a1, a2;
+} Biquad;
+
+// K-weighting = high shelf (head effect) followed by the RLB high-pass,
+// coefficients derived for any sample rate (BS.1770-4, annex 1).
+static void k_weighting(int freq, Biquad *shelf, Biquad *hpf) {
+    double f0 = 1681.974450955533, G = 3.999843853973347, Q = 0.7071752369554196;
+    double K  = tan(M_PI * f0 / freq);
+    double Vh = pow(10.0, G / 20.0);
+    double Vb = pow(Vh, 0.4996667741545416);
+    double a0 = 1.0 + K / Q + K * K;
+    shelf->b0 = (Vh + Vb * K / Q + K * K) / a0;
+    shelf->b1 = 2.0 * (K * K - Vh) / a0;
+    shelf->b2 = (Vh - Vb * K / Q + K * K) / a0;
+    shelf->a1 = 2.0 * (K * K - 1.0) / a0;
+    shelf->a2 = (1.0 - K / Q + K * K) / a0;
+
+    f0 = 38.13547087602444; Q = 0.5003270373238773;
+    K  = tan(M_PI * f0 / freq);
+    a0 = 1.0 + K / Q + K * K;
+    hpf->b0 = 1.0;
+    hpf->b1 = -2.0;
+    hpf->b2 = 1.0;
+    hpf->a1 = 2.0 * (K * K - 1.0) / a0;
+    hpf->a2 = (1.0 - K / Q + K * K) / a0;
+}
+
+// Kernel: K-weight `frames` stereo frames in place and return the sum of squares.
+// Both channels run in lock-step through 2-wide arrays so the compiler can keep
+// them in one vector register; the recursion itself is inherently serial.
+static double weighted_energy(float *x, int frames, const Biquad *s, const Biquad *h,
+                              double z[2][4]) {
+    double sum[2] = {0.0, 0.0};
+    for (int i = 0; i < frames; i++) {
+        for (int c = 0; c < 2; c++) {
+            double in = x[2 * i + c];
+            double y1 = s->b0 * in + z[c][0];
+            z[c][0]   = s->b1 * in - s->a1 * y1 + z[c][1];
+            z[c][1]   = s->b2 * in - s->a2 * y1;
+            double y2 = h->b0 * y1 + z[c][2];
+            z[c][2]   = h->b1 * y1 - h->a1 * y2 + z[c][3];
+            z[c][3]   = h->b2 * y1 - h->a2 * y2;
+            sum[c]   += y2 * y2;
+        }
+    }
+    return sum[0] + sum[1];
+}
+
+// Kernel: largest absolute sample. Branch-free so it vectorises.
+static float block_peak(const float *x, int n) {
+    float peak = 0.0f;
+    for (int i = 0; i < n; i++) {
+        float a = fabsf(x[i]);
+        peak = a > peak ? a : peak;
+    }
+    return peak;
+}
+
+int loudness_measure(const void *pcm, unsigned int bytes, int freq, int channels,
+                     int is_float, double *lufs, double *peak) {
+    if (channels != 2 || freq <= 0) return -1;
+
+    int sample_size = is_float ? 4 : 2;
+    long total   = bytes / (sample_size * 2);
+    int  step    = freq / 10;                  // 100 ms sub-blocks, 4 per gating block
+    long nsub    = total / step;
+    if (nsub < 4) return -1;
+
+    double *sub = malloc(nsub * sizeof(double));
+    if (!sub) return -1;
+
+    Biquad shelf, hpf;
+    k_weighting(freq, &shelf, &hpf);
+    double z[2][4] = {{0}};
+    float  buf[BLOCK_FRAMES * 2];
+    float  max_peak = 0.0f;
+
+    for (long b = 0; b < nsub; b++) {
+        double energy = 0.0;
+        for (int done = 0; done < step; ) {
+            int n = step - done < BLOCK_FRAMES ? step - done : BLOCK_FRAMES;
+            long first = (b * step + done) * 2;
+            if (is_float) {
+                memcpy(buf, (const float *)pcm + first, n * 2 * sizeof(float));
+            } else {
+                const Sint16 *s = (const Sint16 *)pcm + first;
+                for (int i = 0; i < n * 2; i++) buf[i] = s[i] * (1.0f / 32768.0f);
+            }
+            float p = block_peak(buf, n * 2);
+            if (p > max_peak) max_peak = p;
+            energy += weighted_energy(buf, n, &shelf, &hpf, z);
+            done += n;
+        }
+        sub[b] = energy / step;
+    }
+
+    // gating blocks: 400 ms windows every 100 ms; energy is already summed over channels
+    long nblocks = nsub - 3;
+    double abs_sum = 0.0, rel_sum = 0.0;
+    long   abs_n = 0, rel_n = 0;
+    for (long i = 0; i < nblocks; i++) {
+        double e = (sub[i] + sub[i + 1] + sub[i + 2] + sub[i + 3]) / 4.0;
+        if (-0.691 + 10.0 * log10(e + 1e-20) > ABSOLUTE_GATE) {
+            abs_sum += e;
+            abs_n++;
+        }
+    }
+    if (abs_n > 0) {
+        double gate = -0.691 + 10.0 * log10(abs_sum / abs_n) + RELATIVE_GATE;
+        for (long i = 0; i < nblocks; i++) {
+            double e = (sub[i] + sub[i + 1] + sub[i + 2] + sub[i + 3]) / 4.0;
+            if (-0.691 + 10.0 * log10(e + 1e-20) > gate) {
+                rel_sum += e;
+                rel_n++;
+            }
+        }
+    }
+    free(sub);
+
+    *lufs = rel_n > 0 ? -0.691 + 10.0 * log10(rel_sum / rel_n) : ABSOLUTE_GATE;
+    *peak = max_peak;
+    return 0;
+}
+
+// Helper: gain towards TARGET_LUFS, limited so the peak stays under the ceiling
+static float gain_for(double lufs, double peak) {
+    double db = TARGET_LUFS - lufs;
+    if (db > MAX_BOOST_DB) db = MAX_BOOST_DB;
+    if (db < MAX_CUT_DB)   db = MAX_CUT_DB;
+    double gain = pow(10.0, db / 20.0);
+    if (peak > 0.0 && gain * peak > PEAK_CEILING) gain = PEAK_CEILING / peak;
+    return (float)gain;
+}
+
+// Helper: file name without its directory, used as the cache key
+static const char *base_name(const char *path) {
+    const char *slash = strrchr(path, '/');
+    const char *sep   = strrchr(path, PLATFORM_PATH_SEP);
+    const char *base  = slash > sep ? slash : sep;
+    return base ? base + 1 : path;
+}
+
+static long long file_mtime(const char *path) {
+    struct stat st;
+    return stat(path, &st) == 0 ? (long long)st.st_mtime : -1;
+}
+
+// Read previous results; entries whose file changed since are ignored
+static void load_cache(void) {
+    FILE *f = fopen(cache_path, "rb");
+    if (!f) return;
+    fseek(f, 0, SEEK_END);
+    long size = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    char *buffer = malloc(size + 1);
+    if (!buffer) { fclose(f); return; }
+    size_t got = fread(buffer, 1, size, f);
+    buffer[got] = '\0';
+    fclose(f);
+
+    cJSON *json = cJSON_Parse(buffer);
+    free(buffer);
+    if (!json) return;
+
+    for (int i = 0; i < track_count; i++) {
+        TrackLoudness *t = &tracks[i];
+        cJSON *item  = cJSON_GetObjectItem(json, base_name(t->path));
+        cJSON *mtime = cJSON_GetObjectItem(item, "mtime");
+        cJSON *lufs  = cJSON_GetObjectItem(item, "lufs");
+        cJSON *peak  = cJSON_GetObjectItem(item, "peak");
+        if (cJSON_IsNumber(mtime) && cJSON_IsNumber(lufs) && cJSON_IsNumber(peak) &&
+            (long long)mtime->valuedouble == t->mtime) {
+            t->lufs = lufs->valuedouble;
+            t->peak = peak->valuedouble;
+            t->gain = gain_for(t->lufs, t->peak);
+            SDL_AtomicSet(&t->ready, 1);
+        }
+    }
+    cJSON_Delete(json);
+}
+
+static void save_cache(void) {
+    cJSON *json = cJSON_CreateObject();
+    for (int i = 0; i < track_count; i++) {
+        TrackLoudness *t = &tracks[i];
+        if (!SDL_AtomicGet(&t->ready)) continue;
+        cJSON *item = cJSON_AddObjectToObject(json, base_name(t->path));
+        cJSON_AddNumberToObject(item, "mtime", (double)t->mtime);
+        cJSON_AddNumberToObject(item, "lufs", t->lufs);
+        cJSON_AddNumberToObject(item, "peak", t->peak);
+    }
+
+    char *text = cJSON_Print(json);
+    cJSON_Delete(json);
+    if (!text) return;
+
+    FILE *f = fopen(cache_path, "w");
+    if (f) {
+        fputs(text, f);
+        fclose(f);
+    } else {
+        log_error("Could not write loudness cache: %s", cache_path);
+    }
+    cJSON_free(text);
+}
+
+// Worker: one track at a time, so analysis never takes more than one core
+static void analyse_job(void *arg) {
+    (void)arg;
+    int freq, channels;
+    Uint16 format;
+    int measured = 0;
+
+    for (int i = 0; i < track_count && !SDL_AtomicGet(&cancelled); i++) {
+        TrackLoudness *t = &tracks[i];
+        if (SDL_AtomicGet(&t->ready)) continue;
+        audio_device_hold();
+        if (!Mix_QuerySpec(&freq, &format, &channels)) {
+            audio_device_release();
+            break;
+        }
+
+        // a finished transcode is much cheaper to load than the original
+        Mix_Chunk *chunk = Mix_LoadWAV(transcode_cached_path(i, t->path));
+        audio_device_release();  // the chunk is converted; the format is in freq/format
+        if (!chunk) continue;
+
+        double lufs, peak;
+        if (loudness_measure(chunk->abuf, chunk->alen, freq, channels,
+                             SDL_AUDIO_ISFLOAT(format) != 0, &lufs, &peak) == 0) {
+            t->lufs = lufs;
+            t->peak = peak;
+            t->gain = gain_for(lufs, peak);
+            SDL_AtomicSet(&t->ready, 1);   // publishes gain to the mixer thread
+            measured++;
+        }
+        Mix_FreeChunk(chunk);
+    }
+
+    if (measured > 0) save_cache();
+}
+
+int loudness_start(const Settings *settings, char *const *paths, int count) {
+    loudness_stop();
+    if (count <= 0) return -1;
+
+    char cache_dir[MAX_PATH_LEN];
+    if (snprintf(cache_dir, sizeof(cache_dir), "%s%ccache",
+                 settings->asset_directory, PLATFORM_PATH_SEP) >= (int)sizeof(cache_dir) ||
+        snprintf(cache_path, sizeof(cache_path), "%s%cloudness.json",
+                 cache_dir, PLATFORM_PATH_SEP) >= (int)sizeof(cache_path)) {
+        log_error("Loudness cache path too long: %s", settings->asset_directory);
+        return -1;
+    }
+    if (platform_mkdir_p(cache_dir) != 0) {
+        log_error("Failed to create cache directory: %s", cache_dir);
+        return -1;
+    }
+
+    tracks = calloc(count, sizeof(TrackLoudness));
+    if (!tracks) return -1;
+    track_count = count;
+    for (int i = 0; i < count; i++) {
+        snprintf(tracks[i].path, sizeof(tracks[i].path), "%s", paths[i]);
+        tracks[i].mtime = file_mtime(paths[i]);
+        tracks[i].gain  = 1.0f;
+    }
+    load_cache();
+
+    // a single low-priority thread: the mixer keeps every other core to itself
+    SDL_AtomicSet(&cancelled, 0);
+    pool = worker_pool_create(1, SDL_THREAD_PRIORITY_LOW, "loudness");
+    if (!pool) return -1;
+    return worker_pool_submit(pool, analyse_job, NULL);
+}
+
+float loudness_gain(int index) {
+    if (!tracks || index < 0 || index >= track_count) return 1.0f;
+    if (!SDL_AtomicGet(&tracks[index].ready)) return 1.0f;
+    return tracks[index].gain;
+}
+
+void loudness_stop(void) {
+    SDL_AtomicSet(&cancelled, 1);
+    worker_pool_destroy(pool);
+    pool = NULL;
+
+    free(tracks);
+    tracks      = NULL;
+    track_count = 0;
+}
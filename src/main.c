@@ -1,17 +1,85 @@
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
 #include "settings.h"
 #include "pomodoro.h"
 #include "graphics.h"
 #include "music.h"
+#include "platform.h"
+#include "logger.h"
+#include "timing.h"
+#include "startup_profile.h"
+#include "trace.h"
+#include "alloc_stats.h"
+#include "energy.h"
+#include "soak.h"
+#include "replay.h"
+
+// command line options, mainly for simulating whole schedules quickly
+typedef struct {
+    int    virtual_clock;  // 1 when --clock-speed or --clock-step was given
+    double clock_speed;    // <= 0: stepped
+    int    start_given;    // 1 when --start HH:MM was given
+    int    start_hh, start_mm;
+    int    profile_startup; // 1 = print the startup phases and exit after the first frame
+    int    alloc_stats;     // 1 = count heap allocations (HUD, startup profile)
+    int    check_allocs;    // 1 = fail the run if a steady-state frame allocated
+    double duration;        // > 0: stop the session after this many clock seconds
+    const char *energy_report; // --bench-energy output, or NULL
+    int    headless_w, headless_h; // > 0: render offscreen at this size, no window
+    const char *soak_samples;  // --soak output, or NULL
+    const char *record_path;   // --record output, or NULL
+    const char *replay_path;   // --replay input, or NULL
+} Options;
+
+// CPU spent per simulated hour, reported when a virtual clock was in use
+static double  sim_start_time = 0.0;
+static clock_t sim_start_cpu  = 0;
+
+static int check_allocs = 0;  // --check-allocs
+static int unattended   = 0;  // --start or --headless: nobody will press Enter
+static int run_failed   = 0;  // exit with status 1 whatever the checks say
+static const char *energy_report = NULL;  // --bench-energy
 
 // called whenever the program terminates
-static void shutdown(int lid_con) {
-    if (lid_con){
-        system("sudo pmset -a disablesleep 0");
+static void shutdown(void) {
+    platform_release_sleep();
+    replay_finish();
+    if (timing_is_virtual() && sim_start_time > 0.0) {
+        double hours = (get_time_now() - sim_start_time) / 3600.0;
+        double cpu   = (double)(clock() - sim_start_cpu) / CLOCKS_PER_SEC;
+        log_info("Simulated %.2f h using %.2f s CPU (%.2f s per simulated hour)",
+                 hours, cpu, hours > 0.0 ? cpu / hours : 0.0);
+    }
+    int status = run_failed;
+    if (energy_report && energy_write_report(energy_report) != 0) {
+        status = 1;
+    }
+    if (soak_active() && soak_finish() != 0) {
+        status = 1;
+    }
+    if (check_allocs) {
+        long long steady, allocating;
+        graphics_alloc_summary(&steady, &allocating);
+        log_info("%lld of %lld steady-state frames allocated", allocating, steady);
+        if (steady == 0 || allocating > 0) {
+            status = 1;
+        }
     }
     cleanup_graphics();
     cleanup_audio();
-    exit(0);
+    exit(status);
+}
+
+// today's hh:mm as a time_t
+static time_t start_time_today(int hh, int mm) {
+    time_t now = (time_t)get_time_now();
+    struct tm tm_start = *localtime(&now);
+    tm_start.tm_hour = hh;
+    tm_start.tm_min = mm;
+    tm_start.tm_sec = 0;
+    return mktime(&tm_start);
 }
 
 // parse user's key input as time (hh:mm)
@@ -26,14 +94,8 @@ static time_t process_start_screen_input(StartScreenResult *result){
             return (time_t)0;
 
             // The user entered a time (hh:mm)
-        case START_SCREEN_TIME_ENTERED: {
-            time_t now = time(NULL);
-            struct tm tm_start = *localtime(&now);
-            tm_start.tm_hour = hh;
-            tm_start.tm_min = mm;
-            tm_start.tm_sec = 0;
-            return mktime(&tm_start);
-        }
+        case START_SCREEN_TIME_ENTERED:
+            return start_time_today(hh, mm);
 
         // fallback
         default:
@@ -43,82 +105,271 @@ static time_t process_start_screen_input(StartScreenResult *result){
 }
 
 // after all sessions end, wait for the user presses Enter or ESC (or closes the window).
-static void wait_for_enter(int lid_con) {
+static void wait_for_enter(void) {
     SDL_Event e;
 
     while (1) {
-        while (SDL_PollEvent(&e)) {
+        while (replay_poll_event(&e)) {
             if (e.type == SDL_QUIT) {
-                shutdown(lid_con);
+                shutdown();
             }
             if (e.type == SDL_KEYDOWN){
                 if (e.key.keysym.sym == SDLK_RETURN ||
                     e.key.keysym.sym == SDLK_KP_ENTER) {
                     return;
                 } else if (e.key.keysym.sym == SDLK_ESCAPE) {
-                    shutdown(lid_con);
+                    shutdown();
                 }
             } 
         }
-        SDL_Delay(500);
+        SDL_Delay(500);  // real time: this waits for a person
     }
 }
 
-// helper function to inquire power setting.
-static int inquire_power_state(void){
-    char current_status[128];
+// show why audio failed and exit. since graphics initialized, the error can be presented on screen
+static void report_audio_error(void) {
+    const char *audio_err = get_last_audio_error();
+    if (!audio_err) {
+        audio_err = "Audio initialization failed.";
+    }
+    if (unattended) {
+        log_error("%s", audio_err);
+        run_failed = 1;
+        shutdown();
+    }
+    show_fullscreen_message(audio_err);
+    shutdown();  // User pressed Enter to exit. Shutdown procedure
+}
 
-    // Get the current sleep status
-    FILE* pipe = popen("pmset -g | grep Sleep | grep -v \"Sleep On Power Button\"", "r");
-    if (!pipe) {
-        exit(EXIT_FAILURE);
+// audio starts lazily: the first session opens the device, decodes the alarm and
+// waits for the library scan started at launch. Later calls return at once.
+static void wait_for_audio(void) {
+    AudioInitStatus status;
+    while ((status = poll_audio_init()) == AUDIO_INIT_PENDING) {
+        SDL_Delay(10);  // real time, not the session clock: this waits for threads
+    }
+    if (status == AUDIO_INIT_FAILED) {
+        report_audio_error();
     }
-    fgets(current_status, sizeof(current_status), pipe);
-    pclose(pipe);
+}
 
-    // return status  (0='no sleep', 1='sleep')
-    return strstr(current_status, "0") != NULL ? 1 : 0;
+// --clock-speed N   run the clock N times faster than real time
+// --clock-step      step the clock: every wait ends immediately (needs --start)
+// --start HH:MM     skip the start screen; exit when the schedule is done
+// --profile-startup print how long each startup phase took and exit at the first frame
+// --alloc-stats     count heap allocations per frame (F3 overlay) and per startup phase
+// --check-allocs    with --start: exit with status 1 if a steady-state frame allocated
+// --duration S      end the session after S seconds of (possibly simulated) clock time
+// --bench-energy F  with --start: write CPU, wakeups and memory used by the session to F
+// --headless WxH    with --start: draw offscreen with the software renderer, no window
+// --soak F          with --start: repeat the schedule for --duration (default 24 h) with
+//                   constant track changes, alarms and key presses; write memory samples
+//                   to F and exit with status 1 if memory kept growing
+// --record F        write the settings, every input event and every clock reading to F
+// --replay F        run the input recorded in F again, headless at the recorded size and
+//                   with the recorded settings; give the other options of the recorded
+//                   run, except --record
+static int parse_options(int argc, char *argv[], Options *opt) {
+    memset(opt, 0, sizeof(*opt));
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--clock-speed") == 0 && i + 1 < argc) {
+            opt->virtual_clock = 1;
+            opt->clock_speed = strtod(argv[++i], NULL);
+            if (opt->clock_speed <= 0.0) {
+                log_error("--clock-speed needs a positive factor");
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--clock-step") == 0) {
+            opt->virtual_clock = 1;
+            opt->clock_speed = 0.0;
+        } else if (strcmp(argv[i], "--start") == 0 && i + 1 < argc) {
+            if (sscanf(argv[++i], "%2d:%2d", &opt->start_hh, &opt->start_mm) != 2) {
+                log_error("--start expects HH:MM");
+                return 1;
+            }
+            opt->start_given = 1;
+        } else if (strcmp(argv[i], "--profile-startup") == 0) {
+            opt->profile_startup = 1;
+        } else if (strcmp(argv[i], "--alloc-stats") == 0) {
+            opt->alloc_stats = 1;
+        } else if (strcmp(argv[i], "--check-allocs") == 0) {
+            opt->alloc_stats  = 1;
+            opt->check_allocs = 1;
+        } else if (strcmp(argv[i], "--duration") == 0 && i + 1 < argc) {
+            opt->duration = strtod(argv[++i], NULL);
+            if (opt->duration <= 0.0) {
+                log_error("--duration needs a positive number of seconds");
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--bench-energy") == 0 && i + 1 < argc) {
+            opt->energy_report = argv[++i];
+        } else if (strcmp(argv[i], "--headless") == 0 && i + 1 < argc) {
+            if (sscanf(argv[++i], "%dx%d", &opt->headless_w, &opt->headless_h) != 2 ||
+                opt->headless_w <= 0 || opt->headless_h <= 0) {
+                log_error("--headless expects WIDTHxHEIGHT");
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--soak") == 0 && i + 1 < argc) {
+            opt->soak_samples = argv[++i];
+        } else if (strcmp(argv[i], "--record") == 0 && i + 1 < argc) {
+            opt->record_path = argv[++i];
+        } else if (strcmp(argv[i], "--replay") == 0 && i + 1 < argc) {
+            opt->replay_path = argv[++i];
+        } else {
+            log_error("Unknown option: %s", argv[i]);
+            return 1;
+        }
+    }
+    // a stepped clock never waits, so an interactive screen would spin
+    if (opt->virtual_clock && opt->clock_speed <= 0.0 && !opt->start_given) {
+        log_error("--clock-step needs --start");
+        return 1;
+    }
+    if (opt->check_allocs && !opt->start_given) {
+        log_error("--check-allocs needs --start");
+        return 1;
+    }
+    if (opt->energy_report && !opt->start_given) {
+        log_error("--bench-energy needs --start");
+        return 1;
+    }
+    if (opt->soak_samples) {
+        if (!opt->start_given) {
+            log_error("--soak needs --start");
+            return 1;
+        }
+        if (opt->duration <= 0.0) {
+            opt->duration = 24 * 3600.0;
+        }
+    }
+    // a recording brings its own input and clock
+    if (opt->replay_path && (opt->record_path || opt->virtual_clock)) {
+        log_error("--replay cannot be combined with --record or a clock option");
+        return 1;
+    }
+    // nobody could type a start time into an offscreen surface
+    if (opt->headless_w > 0 && !opt->start_given && !opt->replay_path) {
+        log_error("--headless needs --start");
+        return 1;
+    }
+    return 0;
 }
 
-int main(void) {
-    // load settings and initialize
-    Settings s = load_settings();
+int main(int argc, char *argv[]) {
+    TRACE_INIT();
+    TRACE_THREAD_NAME("main");
 
-    // decide whether to touch lid
-    int lid_con = 0;
-    if (s.lid_con){
-        lid_con = inquire_power_state();
+    Options opt;
+    if (parse_options(argc, argv, &opt)) {
+        return 1;
+    }
+    if (opt.profile_startup) {
+        startup_profile_enable();
+    }
+    // before anything can allocate through SDL or cJSON
+    if (opt.alloc_stats && alloc_stats_install() != 0) {
+        log_error("Could not install the counting allocators");
+        return 1;
+    }
+    check_allocs = opt.check_allocs;
+    if (opt.energy_report) {
+        audio_measure_thread_cpu();  // before the device opens
     }
 
-    if (init_graphics(&s)) {   // if init_graphics returns an error.
-        fprintf(stderr, "Failed to initialize graphics\n");
+    // a replay runs on the settings it was recorded with, not the local file
+    if (opt.replay_path && replay_load(opt.replay_path) != 0) {
+        log_error("Could not read the recording: %s", opt.replay_path);
         return 1;
     }
 
-    if (!init_audio(&s)) {     // since graphics initialized, audio error can be presented on screen
-        const char *audio_err = get_last_audio_error();
-        if (!audio_err) {
-            audio_err = "Audio initialization failed.";
+    // load settings and initialize
+    StartupMark t = startup_phase_begin();
+    Settings s;
+    if (opt.replay_path && replay_settings()) {
+        if (parse_settings(replay_settings(), &s) != 0) {
+            log_error("The settings in the recording are damaged: %s", opt.replay_path);
+            return 1;
         }
+    } else {
+        s = load_settings();
+    }
+    startup_phase_end("load_settings", t);
+
+    // from here on diagnostics are queued and written by the logger thread
+    char log_path[MAX_PATH_LEN];
+    int log_path_fits = snprintf(log_path, sizeof(log_path), "%s%cstudy-with-this.log",
+                                 s.asset_directory, PLATFORM_PATH_SEP) < (int)sizeof(log_path);
+    logger_init(LOG_LEVEL_INFO, s.log_file && log_path_fits ? log_path : NULL);
+    timing_init();
+
+#ifdef ENABLE_TRACE
+    char trace_path[MAX_PATH_LEN];
+    if (snprintf(trace_path, sizeof(trace_path), "%s%cstudy-with-this.trace.json",
+                 s.asset_directory, PLATFORM_PATH_SEP) < (int)sizeof(trace_path)) {
+        TRACE_SET_OUTPUT(trace_path);
+    }
+#endif
 
-        // Show the error in the window before the initial UI.
-        show_fullscreen_message(audio_err);
-        shutdown(lid_con);  // User pressed Enter to exit. Shutdown procedure
+    // a simulated run starts right at the requested start time
+    if (opt.virtual_clock) {
+        double start = opt.start_given
+            ? (double)start_time_today(opt.start_hh, opt.start_mm)
+            : get_time_now();
+        timing_use_virtual_clock(start, opt.clock_speed);
+        sim_start_time = start;
+        sim_start_cpu  = clock();
     }
 
-    if (lid_con){
-        system("sudo pmset -a disablesleep 1");
+    // recorded from here on, through whichever clock is in place
+    if (opt.record_path) {
+        char *settings_json = read_settings_text();
+        int failed = replay_record_begin(opt.record_path, s.width, s.height, settings_json);
+        free(settings_json);
+        if (failed) {
+            log_error("Could not write the recording: %s", opt.record_path);
+            return 1;
+        }
+    }
+    if (opt.replay_path) {
+        replay_play_begin();
+        if (opt.headless_w == 0) {
+            replay_window_size(&opt.headless_w, &opt.headless_h);
+        }
+    }
+
+    // the music scan runs on a worker from launch; no audio device is opened
+    // until a session begins (see wait_for_audio)
+    init_audio_begin(&s);
+
+    t = startup_phase_begin();
+    unattended = opt.start_given || opt.headless_w > 0;
+    int graphics_failed = opt.headless_w > 0
+        ? init_graphics_headless(opt.headless_w, opt.headless_h)
+        : init_graphics(&s);
+    startup_phase_end("init_graphics", t);
+    if (graphics_failed) {   // if init_graphics returns an error.
+        log_error("Failed to initialize graphics");
+        return 1;
+    }
+
+    // keep the machine awake through the sessions
+    if (s.lid_con && opt.headless_w == 0 && platform_inhibit_sleep("Study-with-this session running") != 0) {
+        log_warn("Could not keep the machine awake");
     }
 
     // get string input from the user and start pomodoro
+    double run_end = 0.0;
     while (1) {
-        StartScreenResult res;
-        time_t base     = process_start_screen_input(&res);
-        time_t now      = time(NULL);
+        StartScreenResult res = START_SCREEN_TIME_ENTERED;
+        time_t base     = soak_active()
+            ? (time_t)get_time_now()     // the next round of a soak run starts at once
+            : opt.start_given
+            ? start_time_today(opt.start_hh, opt.start_mm)
+            : process_start_screen_input(&res);
 
         // If the user exit the program and did not enter a time
         if (res == START_SCREEN_QUIT || base == 1) {
-            shutdown(lid_con);
+            shutdown();
         }
 
         // If the user wants to change settings.json
@@ -127,25 +378,40 @@ int main(void) {
             open_settings_in_file_manager();
 
             show_fullscreen_message("Restart the app to apply your new settings.");
-            shutdown(lid_con);  // User pressed Enter to exit. Shutdown procedure
-        }
-
-        // default case: a time is given.
-        double seconds_until = difftime(base, now);
-        if (seconds_until > 0) {                                // a future time is given. start with break time.
-            run_timer(base, BREAK, (int)seconds_until,
-                      -1, NULL, NULL, 0);
-            play_alarm();
+            shutdown();  // User pressed Enter to exit. Shutdown procedure
         }
 
         // start pomodoro
+        wait_for_audio();
+        if (graphics_load_deferred_fonts() != 0) {
+            shutdown();
+        }
+        if (opt.duration > 0.0 && !soak_active()) {
+            run_end = get_time_now() + opt.duration;
+            pomodoro_set_time_limit(run_end);
+        }
+        if (opt.soak_samples && !soak_active()) {
+            soak_begin(opt.soak_samples);
+        }
+        if (opt.energy_report) {
+            energy_report = opt.energy_report;
+            energy_begin();
+        }
         if(run_pomodoro(&s, base) == 1){
             // Terminated prematurely
-            shutdown(lid_con);
+            shutdown();
+        }
+
+        // a scripted run ends with the schedule; a soak run goes round until --duration
+        if (soak_active() && get_time_now() < run_end) {
+            continue;  // no one is there to press Enter
+        }
+        if (opt.start_given) {
+            break;
         }
 
         // end of final work session, wait for the user to hit Enter
-        wait_for_enter(lid_con);
+        wait_for_enter();
     }
-    shutdown(lid_con);
+    shutdown();
 }
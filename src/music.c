@@ -1,4 +1,13 @@
 #include "music.h"
+#include "transcode.h"
+#include "loudness.h"
+#include "bell_synth.h"
+#include "visualizer.h"
+#include "logger.h"
+#include "startup_profile.h"
+#include "worker.h"
+#include "trace.h"
+#include "platform.h"
 #include <time.h>
 #include <SDL.h>
 #include <SDL_mixer.h>
@@ -8,6 +17,11 @@
 #include <stdarg.h>
 #include <stdio.h>
 #define MAX_HISTORY_SIZE 100   // upper bound for played music memory
+#define MUSIC_BUFFER_FRAMES 4096   // device buffer while music plays: few wakeups
+#define ALARM_BUFFER_FRAMES 512    // device buffer around the alarm: low latency
+#define NOISE_LANES 4              // independent xorshift generators stepped together
+#define NOISE_BLOCK 1024           // random samples generated per batch
+#define NOISE_FADE_STEP 0.0005f    // gain change per frame (~40 ms fade at 48 kHz)
 
 static Mix_Chunk *alarm_chunk     = NULL;
 static Mix_Music *current_music   = NULL;
@@ -21,7 +35,65 @@ static int        current_volume  = MIX_MAX_VOLUME/2;
 static int        previous_volume = MIX_MAX_VOLUME/2;
 static int        alarm_channel   = -1;
 static int        current_index   = 0;                  // index of the last‐played track
+static int        buffer_frames   = 0;                  // frames per device buffer as opened
+static char       alarm_path[MAX_PATH_LEN] = {0};
 static bool       muted           = false;
+static bool       synth_alarm     = false;              // alarm rendered by bell_synth instead of a file
+static float      track_gain      = 1.0f;               // loudness normalization of the current track
+static AmbientType ambient        = AMBIENT_LOFI;       // what plays during work sessions
+static bool       lofi_wanted     = false;              // a session wants music; set by play_lofi, cleared by stop_lofi
+static SDL_mutex *device_lock     = NULL;               // guards device_holders and the reopen
+static int        device_holders  = 0;                  // workers relying on the device format
+
+// staged init: the scan and the alarm decode run on workers, the rest on the main thread
+typedef enum {
+    INIT_STAGE_IDLE,
+    INIT_STAGE_SCAN,        // scan running; device not open yet
+    INIT_STAGE_LOADING,     // device open; waiting for the workers
+    INIT_STAGE_READY,
+    INIT_STAGE_FAILED
+} InitStage;
+static InitStage    init_stage = INIT_STAGE_IDLE;
+static bool         audio_started = false;              // open_audio() ran: device and mixer in use
+static Settings     init_settings;                      // copy for the workers
+static WorkerPool  *init_pool  = NULL;
+static SDL_atomic_t init_jobs;                          // startup jobs still running
+static char         scan_err[256]  = {0};               // written by the scan job; paths are cut short
+static char         alarm_err[256] = {0};               // written by the alarm job
+
+// events posted by SDL_mixer's thread, handled on the main thread by process_audio_events()
+enum {
+    AUDIO_EVENT_MUSIC_FINISHED = 1 << 0
+};
+static SDL_atomic_t pending_events;
+
+// mixer thread CPU for the energy benchmark, sampled by a post-mix effect
+static bool         measure_audio_cpu = false;
+static SDL_atomic_t audio_cpu_ms;                       // current device thread, as last sampled
+static int          audio_cpu_base_ms = 0;              // device threads already closed
+
+// ambient noise generator, run by SDL_mixer's thread through Mix_HookMusic
+static const char *ambient_names[AMBIENT_COUNT] = {
+    "lofi", "white", "pink", "brown", "rain"
+};
+static const char *ambient_labels[AMBIENT_COUNT] = {
+    "", "White noise", "Pink noise", "Brown noise", "Rain"
+};
+static bool         noise_active  = false;
+static SDL_atomic_t noise_level;                        // target volume 0-128, written by the main thread
+static SDL_atomic_t noise_request;                      // AmbientType the generator should crossfade to
+static int          noise_type    = AMBIENT_WHITE;      // AmbientType being generated right now
+static float        noise_gain    = 0.0f;               // current (smoothed) gain
+static int          noise_channels = 2;
+static Uint16       noise_format  = AUDIO_S16SYS;
+static Uint32       noise_rng[NOISE_LANES] = { 0x9E3779B9u, 0x7F4A7C15u, 0x85EBCA6Bu, 0xC2B2AE35u };
+static float        noise_buf[NOISE_BLOCK];             // batch of white samples in [-1, 1)
+static int          noise_buf_pos = NOISE_BLOCK;
+static float        pink_b[2][3]  = {{0}};              // filter states, per channel
+static float        brown_b[2]    = {0};
+static float        rain_hp[2]    = {0};
+static float        rain_prev[2]  = {0};
+static float        rain_drop     = 0.0f;
 
 // Helper: case‐insensitive extension check
 static bool has_ext(const char *fname, const char *ext) {
@@ -54,69 +126,165 @@ const char *get_last_audio_error(void) {
     return (audio_err[0] != '\0') ? audio_err : NULL;
 }
 
+// Helper: post an event from a mixer callback. Lock-free and allocation-free,
+// so it is safe on the audio thread; the main loop picks it up next frame.
+static void post_audio_event(int event) {
+    int old;
+    do {
+        old = SDL_AtomicGet(&pending_events);
+    } while (!SDL_AtomicCAS(&pending_events, old, old | event));
+}
+
+// Mix_HookMusicFinished callback. Runs on SDL_mixer's thread (or inside Mix_HaltMusic),
+// so it must not touch any playback state itself.
+static void on_music_finished(void) {
+    post_audio_event(AUDIO_EVENT_MUSIC_FINISHED);
+}
+
+// Helper: music volume is the user's level scaled by the track's loudness gain
+static void apply_music_volume(void) {
+    SDL_AtomicSet(&noise_level, muted ? 0 : current_volume);
+    if (muted) {
+        Mix_VolumeMusic(0);
+        return;
+    }
+    int level = (int)(current_volume * track_gain + 0.5f);
+    if (level > MIX_MAX_VOLUME) level = MIX_MAX_VOLUME;
+    Mix_VolumeMusic(level);
+}
+
+
+// Post-mix effect: runs on the mixer thread once per buffer and leaves the stream alone
+static void sample_audio_cpu(int chan, void *stream, int len, void *udata) {
+    (void)chan; (void)stream; (void)len; (void)udata;
+    SDL_AtomicSet(&audio_cpu_ms, (int)(platform_thread_cpu_ns() / 1000000));
+}
+
+// Helper: open the device at its native rate so SDL does not resample every buffer.
+// SDL may still hand us a different rate or buffer size; Mix_QuerySpec tells what we got.
+static int open_audio_device(int frames) {
+    // a reopened device gets a new thread, with its own CPU clock
+    audio_cpu_base_ms += SDL_AtomicSet(&audio_cpu_ms, 0);
+
+    int freq = MIX_DEFAULT_FREQUENCY;
+#if SDL_VERSION_ATLEAST(2, 24, 0)
+    SDL_AudioSpec native;
+    if (SDL_InitSubSystem(SDL_INIT_AUDIO) == 0 &&
+        SDL_GetDefaultAudioInfo(NULL, &native, 0) == 0 && native.freq > 0) {
+        freq = native.freq;
+    }
+#endif
+    if (Mix_OpenAudioDevice(freq, MIX_DEFAULT_FORMAT, 2, frames, NULL,
+                            SDL_AUDIO_ALLOW_FREQUENCY_CHANGE |
+                            SDL_AUDIO_ALLOW_SAMPLES_CHANGE) < 0) {
+        return -1;
+    }
+    buffer_frames = frames;
+    if (measure_audio_cpu) {
+        Mix_RegisterEffect(MIX_CHANNEL_POST, sample_audio_cpu, NULL, NULL);
+    }
+    return 0;
+}
+
+void audio_measure_thread_cpu(void) {
+    measure_audio_cpu = true;
+}
+
+double audio_thread_cpu_seconds(void) {
+    return (audio_cpu_base_ms + SDL_AtomicGet(&audio_cpu_ms)) / 1000.0;
+}
 
 const char* get_current_lofi_name(void) {
+    if (ambient != AMBIENT_LOFI) return ambient_labels[ambient];
+    if (lofi_count == 0) return "";   // nothing scanned (yet)
     const char *full = lofi_paths[current_index];
     const char *base = strrchr(full, '/');
     return base ? base + 1 : full;
 }
 
-int init_audio(const Settings *settings) {
-    srand((unsigned)time(NULL));             // seeding the random number generator choosing a lofi music
-    audio_err[0] = '\0';                     // clear previous error message
-    lofi_count   = 0;                        // clear the counter of lofi tracks, if set previously
-
-    if (Mix_OpenAudio(44100, MIX_DEFAULT_FORMAT, 2, 1024) < 0) {
-        const char *mix_err = Mix_GetError();
-        fprintf(stderr, "Mix_OpenAudio Error: %s\n", mix_err);
-        set_audio_error("Audio system error: %s", mix_err);
-        return 0;
-    }
-    Mix_HookMusicFinished(play_lofi);
+// Helper: does the file name look like a track we can play
+static bool is_track(const char *name) {
+    return has_ext(name, ".mp3") || has_ext(name, ".wav") || has_ext(name, ".ogg");
+}
 
-    // Load alarm chunk
-    alarm_chunk = Mix_LoadWAV(settings->alarm_sound);
-    if (!alarm_chunk) {
-        const char *mix_err = Mix_GetError();
-        fprintf(stderr, "Mix_LoadWAV Error: %s\n", mix_err);
-        printf("[DEBUG] Full bell path: %s\n", settings->alarm_sound);
-        set_audio_error("Failed to bell sound from\n%s\n\n%s",
-            settings->alarm_sound,
-            mix_err
-            );
-        return 0;
-    }
+// Worker job: scan the music directory for files with mp3, wav, ogg.
+// Publishes lofi_paths/lofi_count only when complete; errors go to scan_err.
+static void scan_music_job(void *arg) {
+    (void)arg;
+    StartupMark t = startup_phase_begin();
+    const char *dir = init_settings.music_directory;
 
-    // Scan music directory for files with mp3, wav, ogg
-    DIR *d = opendir(settings->music_directory);
+    DIR *d = opendir(dir);
     if (!d) {
-        fprintf(stderr, "Could not open music directory: %s\n",
-                settings->music_directory);
-        set_audio_error("Could not open music directory from\n%s",
-                        settings->music_directory);
-        return 0;
+        log_error("Could not open music directory: %s", dir);
+        snprintf(scan_err, sizeof(scan_err), "Could not open music directory from\n%.200s", dir);
+        SDL_AtomicAdd(&init_jobs, -1);
+        return;
     }
     struct dirent *ent;
     // First pass: count files
+    int count = 0;
     while ((ent = readdir(d))) {
-        if (has_ext(ent->d_name, ".mp3")
-             || has_ext(ent->d_name, ".wav")
-             || has_ext(ent->d_name, ".ogg")) {
-            lofi_count++;
-        }
+        if (is_track(ent->d_name)) count++;
     }
 
-    if (lofi_count < 4) {
-        fprintf(stderr,
-                "Not enough audio files found in: %s. At least four tracks required.\n",
-                settings->music_directory);
-        set_audio_error("Not enough lofi tracks. At least four required in\n%s.",
-                        settings->music_directory);
+    if (count < 4) {
+        log_error(
+                "Not enough audio files found in: %s. At least four tracks required.", dir);
+        snprintf(scan_err, sizeof(scan_err),
+                 "Not enough lofi tracks. At least four required in\n%.200s.", dir);
         closedir(d);
-        return 0;
+        SDL_AtomicAdd(&init_jobs, -1);
+        return;
     }
     rewinddir(d);
 
+    // Second pass: allocate and fill path list
+    char **paths = malloc(count * sizeof(char*));
+    int idx = 0;
+    while ((ent = readdir(d)) && idx < count) {
+        if (is_track(ent->d_name)) {
+            size_t len = strlen(dir) + 1 + strlen(ent->d_name) + 1;
+            char *full = malloc(len);
+            snprintf(full, len, "%s/%s", dir, ent->d_name);
+            paths[idx++] = full;
+        }
+    }
+    closedir(d);
+
+    lofi_paths = paths;
+    lofi_count = idx;
+    startup_phase_end("music_scan", t);
+    SDL_AtomicAdd(&init_jobs, -1);  // full barrier: the main thread sees the list after this
+}
+
+// Worker job: decode the alarm file into the opened device's format
+static void load_alarm_job(void *arg) {
+    (void)arg;
+    StartupMark t = startup_phase_begin();
+    alarm_chunk = Mix_LoadWAV(init_settings.alarm_sound);
+    if (!alarm_chunk) {
+        const char *mix_err = Mix_GetError();
+        log_error("Mix_LoadWAV Error: %s", mix_err);
+        log_debug("Full bell path: %s", init_settings.alarm_sound);
+        snprintf(alarm_err, sizeof(alarm_err), "Failed to bell sound from\n%.120s\n\n%.100s",
+                 init_settings.alarm_sound, mix_err);
+    }
+    startup_phase_end("alarm_load", t);
+    SDL_AtomicAdd(&init_jobs, -1);
+}
+
+// Helper: everything after the workers are done. Main thread.
+static AudioInitStatus finish_audio_init(void) {
+    worker_pool_destroy(init_pool);   // idle by now; joins the threads
+    init_pool = NULL;
+
+    // report errors in the order a serial init would have hit them
+    if (alarm_err[0] != '\0' || scan_err[0] != '\0') {
+        set_audio_error("%s", alarm_err[0] != '\0' ? alarm_err : scan_err);
+        return AUDIO_INIT_FAILED;
+    }
+
     // initialize played music memory of size a third of lofi_count
     history_size = lofi_count / 3;
     if (history_size > MAX_HISTORY_SIZE) history_size = MAX_HISTORY_SIZE;
@@ -124,34 +292,145 @@ int init_audio(const Settings *settings) {
     recent_history = calloc(history_size, sizeof(int));
     for (int i = 0; i < history_size; i++) recent_history[i] = -1;  // initialize all slots with -1
 
-    // Second pass: allocate and fill path list
-    lofi_paths = malloc(lofi_count * sizeof(char*));
-    int idx = 0;
-    while ((ent = readdir(d))) {
-        if (has_ext(ent->d_name, ".mp3")
-             || has_ext(ent->d_name, ".wav")
-             || has_ext(ent->d_name, ".ogg")) {
-            size_t len = strlen(settings->music_directory) + 1 + strlen(ent->d_name) + 1;
-            char *full = malloc(len);
-            snprintf(full, len, "%s/%s", settings->music_directory, ent->d_name);
-            lofi_paths[idx++] = full;
-        }
+    // Optionally pre-decode the library in the background; play_lofi() picks up finished copies
+    if (init_settings.transcode_cache) {
+        transcode_cache_start(&init_settings, lofi_paths, lofi_count);
+    }
+
+    // Measure track loudness in the background; play_lofi() applies the gain
+    if (init_settings.normalize_loudness) {
+        loudness_start(&init_settings, lofi_paths, lofi_count);
+    }
+
+    // Spectrum bars around the pie, fed from the mixer output
+    if (init_settings.visualizer && visualizer_start() != 0) {
+        log_warn("Visualizer unavailable for this audio format");
+    }
+
+    // What plays during work: lofi tracks or a noise colour
+    ambient = AMBIENT_LOFI;
+    for (int i = 0; i < AMBIENT_COUNT; i++) {
+        if (strcasecmp(init_settings.ambient, ambient_names[i]) == 0) ambient = i;
     }
-    closedir(d);
 
     // Set initial volume
     current_volume = previous_volume = MIX_MAX_VOLUME/2;
-    Mix_VolumeMusic(current_volume);
-    Mix_VolumeChunk(alarm_chunk, current_volume);
+    track_gain = 1.0f;
     muted = false;
+    apply_music_volume();
+    Mix_VolumeChunk(alarm_chunk, current_volume);
 
     current_music = NULL;
-    return 1;
+    return AUDIO_INIT_READY;
+}
+
+// Helper: open the device and start the alarm decode. Main thread.
+static AudioInitStatus open_audio(void) {
+    audio_started = true;
+    StartupMark t = startup_phase_begin();
+    if (open_audio_device(MUSIC_BUFFER_FRAMES) < 0) {
+        const char *mix_err = Mix_GetError();
+        log_error("Mix_OpenAudioDevice Error: %s", mix_err);
+        set_audio_error("Audio system error: %s", mix_err);
+        return AUDIO_INIT_FAILED;
+    }
+    Mix_HookMusicFinished(on_music_finished);
+    startup_phase_end("Mix_OpenAudioDevice", t);
+
+    // Load alarm chunk, or set up the synthesized bell when a preset is chosen
+    snprintf(alarm_path, sizeof(alarm_path), "%s", init_settings.alarm_sound);
+    synth_alarm = init_settings.alarm_synth[0] != '\0';
+    if (synth_alarm) {
+        alarm_chunk = bell_synth_init(init_settings.alarm_synth);
+        if (!alarm_chunk) {
+            log_error("Unknown alarm_synth preset: %s", init_settings.alarm_synth);
+            set_audio_error("Unknown alarm_synth preset \"%s\".\nUse bell, chime or bowl.",
+                            init_settings.alarm_synth);
+            return AUDIO_INIT_FAILED;
+        }
+    } else {
+        SDL_AtomicAdd(&init_jobs, 1);
+        if (!init_pool || worker_pool_submit(init_pool, load_alarm_job, NULL) != 0) {
+            load_alarm_job(NULL);  // no worker: decode here
+        }
+    }
+    return AUDIO_INIT_PENDING;
+}
+
+void init_audio_begin(const Settings *settings) {
+    srand((unsigned)time(NULL));             // seeding the random number generator choosing a lofi music
+    audio_err[0] = scan_err[0] = alarm_err[0] = '\0';  // clear previous error messages
+    lofi_count   = 0;                        // clear the counter of lofi tracks, if set previously
+    init_settings = *settings;
+    init_stage    = INIT_STAGE_SCAN;
+    if (!device_lock) device_lock = SDL_CreateMutex();
+
+    // the scan only touches the file system, so it can start before SDL is up
+    SDL_AtomicSet(&init_jobs, 1);
+    init_pool = worker_pool_create(2, SDL_THREAD_PRIORITY_NORMAL, "audio-init");
+    if (!init_pool || worker_pool_submit(init_pool, scan_music_job, NULL) != 0) {
+        scan_music_job(NULL);  // no worker: scan here
+    }
+}
+
+AudioInitStatus poll_audio_init(void) {
+    switch (init_stage) {
+    case INIT_STAGE_SCAN: {
+        init_stage = INIT_STAGE_LOADING;
+        AudioInitStatus status = open_audio();
+        if (status == AUDIO_INIT_FAILED) {
+            worker_pool_destroy(init_pool);
+            init_pool = NULL;
+            init_stage = INIT_STAGE_FAILED;
+        }
+        return status;
+    }
+    case INIT_STAGE_LOADING:
+        if (SDL_AtomicGet(&init_jobs) > 0) return AUDIO_INIT_PENDING;
+        init_stage = finish_audio_init() == AUDIO_INIT_READY ? INIT_STAGE_READY : INIT_STAGE_FAILED;
+        return init_stage == INIT_STAGE_READY ? AUDIO_INIT_READY : AUDIO_INIT_FAILED;
+    case INIT_STAGE_READY:
+        return AUDIO_INIT_READY;
+    default:
+        return AUDIO_INIT_FAILED;
+    }
+}
+
+int init_audio(const Settings *settings) {
+    init_audio_begin(settings);
+    AudioInitStatus status;
+    while ((status = poll_audio_init()) == AUDIO_INIT_PENDING) {
+        SDL_Delay(1);
+    }
+    return status == AUDIO_INIT_READY;
 }
 
 // called when the program terminates. cleans up the audio
 void cleanup_audio(void) {
+    // quitting before the startup jobs finished: let them end first
+    if (init_pool) {
+        worker_pool_destroy(init_pool);
+        init_pool = NULL;
+    }
+
+    // quit from the start screen: the device was never opened, only the scan ran
+    if (!audio_started) {
+        for (int i = 0; i < lofi_count; i++) {
+            free(lofi_paths[i]);
+        }
+        free(lofi_paths);
+        lofi_paths = NULL;
+        lofi_count = 0;
+        return;
+    }
     stop_lofi();
+    visualizer_stop();
+    loudness_stop();
+    transcode_cache_stop();
+    if (synth_alarm) {
+        bell_synth_free();
+        alarm_chunk = NULL;
+    }
     if (alarm_chunk) { Mix_FreeChunk(alarm_chunk); alarm_chunk = NULL; }
 
     for (int i = 0; i < lofi_count; i++) {
@@ -165,10 +444,188 @@ void cleanup_audio(void) {
     recent_history = NULL;
 
     Mix_CloseAudio();
+    logger_audio_closed();
+    SDL_DestroyMutex(device_lock);  // the workers above are joined
+    device_lock = NULL;
 }
 
-void play_lofi(void) {
-    stop_lofi();
+void audio_device_hold(void) {
+    SDL_LockMutex(device_lock);
+    device_holders++;
+    SDL_UnlockMutex(device_lock);
+}
+
+void audio_device_release(void) {
+    SDL_LockMutex(device_lock);
+    device_holders--;
+    SDL_UnlockMutex(device_lock);
+}
+
+// Helper: close and reopen the device with `frames` per buffer. Main thread, with
+// device_lock held.
+static void reopen_audio_device(int frames) {
+    int old_freq, freq, channels;
+    Uint16 old_format, format;
+    Mix_QuerySpec(&old_freq, &old_format, &channels);
+
+    Mix_CloseAudio();
+    logger_audio_closed();
+    if (open_audio_device(frames) < 0 &&
+        open_audio_device(buffer_frames) < 0) {
+        log_error("Mix_OpenAudioDevice Error: %s", Mix_GetError());
+        buffer_frames = 0;
+        return;
+    }
+    Mix_HookMusicFinished(on_music_finished);
+
+    // the alarm was converted for the old device; decode it again if the format moved
+    Mix_QuerySpec(&freq, &format, &channels);
+    if ((freq != old_freq || format != old_format) && alarm_chunk && !synth_alarm) {
+        Mix_FreeChunk(alarm_chunk);
+        alarm_chunk = Mix_LoadWAV(alarm_path);
+        if (!alarm_chunk) log_error("Mix_LoadWAV Error: %s", Mix_GetError());
+    }
+
+    // the band edges depend on the rate
+    if (visualizer_active()) {
+        visualizer_start();
+    }
+
+    // reopening resets the per-channel volumes
+    alarm_channel = -1;
+    apply_music_volume();
+    Mix_VolumeChunk(alarm_chunk, muted ? 0 : current_volume);
+}
+
+void set_audio_buffer_mode(AudioBufferMode mode) {
+    int frames = (mode == AUDIO_BUFFER_ALARM) ? ALARM_BUFFER_FRAMES : MUSIC_BUFFER_FRAMES;
+    if (buffer_frames == 0 || frames == buffer_frames) return;
+
+    // SDL cannot resize the buffer of an open device, so reopen it.
+    // Only while idle: anything playing would be cut off.
+    if (Mix_PlayingMusic() || is_alarm_playing()) return;
+
+    // nor while a worker decodes for the current format; the caller tries again later.
+    // Holding the lock keeps new holders out until the device is back.
+    if (!device_lock || SDL_TryLockMutex(device_lock) != 0) return;
+    if (device_holders > 0) {
+        SDL_UnlockMutex(device_lock);
+        return;
+    }
+    reopen_audio_device(frames);
+    SDL_UnlockMutex(device_lock);
+}
+
+
+// Helper: refill noise_buf. The lanes are independent xorshift32 generators,
+// so the inner loop has no dependency between iterations and vectorises.
+static void noise_fill(void) {
+    for (int i = 0; i < NOISE_BLOCK; i += NOISE_LANES) {
+        for (int l = 0; l < NOISE_LANES; l++) {
+            Uint32 x = noise_rng[l];
+            x ^= x << 13;
+            x ^= x >> 17;
+            x ^= x << 5;
+            noise_rng[l] = x;
+            noise_buf[i + l] = (float)(Sint32)x * (1.0f / 2147483648.0f);
+        }
+    }
+    noise_buf_pos = 0;
+}
+
+// Helper: next white sample in [-1, 1)
+static float noise_white(void) {
+    if (noise_buf_pos >= NOISE_BLOCK) noise_fill();
+    return noise_buf[noise_buf_pos++];
+}
+
+// Helper: one sample of the current colour for channel `c`
+static float noise_sample(int c) {
+    float w = noise_white();
+    switch (noise_type) {
+    case AMBIENT_PINK: {
+        // Paul Kellet's three-pole approximation of a -3 dB/octave slope
+        float *b = pink_b[c];
+        b[0] = 0.99765f * b[0] + w * 0.0990460f;
+        b[1] = 0.96300f * b[1] + w * 0.2965164f;
+        b[2] = 0.57000f * b[2] + w * 1.0526913f;
+        return (b[0] + b[1] + b[2] + w * 0.1848f) * 0.22f;
+    }
+    case AMBIENT_BROWN:
+        // leaky integrator: -6 dB/octave without drifting off
+        brown_b[c] = (brown_b[c] + 0.02f * w) / 1.02f;
+        return brown_b[c] * 3.5f;
+    case AMBIENT_RAIN: {
+        // hiss: high-passed white noise, plus sparse decaying drops shared by both channels
+        rain_hp[c] = 0.9f * (rain_hp[c] + w - rain_prev[c]);
+        rain_prev[c] = w;
+        if (c == 0) {
+            rain_drop *= 0.996f;
+            if (noise_white() > 0.9993f) rain_drop = 0.3f + 0.4f * (noise_white() + 1.0f) * 0.5f;
+        }
+        return rain_hp[c] * 0.25f + rain_drop * w * 0.5f;
+    }
+    default:
+        return w * 0.3f;
+    }
+}
+
+// Mix_HookMusic generator. Fades towards the target volume, and through silence
+// when a different colour is requested, so neither volume keys nor switching click.
+void ambient_noise_mixer(void *udata, Uint8 *stream, int len) {
+    (void)udata;
+    int frame_bytes = noise_channels * SDL_AUDIO_BITSIZE(noise_format) / 8;
+    int frames = len / frame_bytes;
+    bool is_float = SDL_AUDIO_ISFLOAT(noise_format);
+    int request = SDL_AtomicGet(&noise_request);
+    float target = SDL_AtomicGet(&noise_level) / (float)MIX_MAX_VOLUME;
+
+    for (int i = 0; i < frames; i++) {
+        float want = (request != noise_type) ? 0.0f : target;
+        if (noise_gain < want)      noise_gain = SDL_min(want, noise_gain + NOISE_FADE_STEP);
+        else if (noise_gain > want) noise_gain = SDL_max(want, noise_gain - NOISE_FADE_STEP);
+        if (request != noise_type && noise_gain == 0.0f) noise_type = request;
+
+        for (int c = 0; c < noise_channels; c++) {
+            float v = noise_sample(c < 2 ? c : 1) * noise_gain;
+            if (v > 1.0f)  v = 1.0f;
+            if (v < -1.0f) v = -1.0f;
+            if (is_float) ((float *)stream)[i * noise_channels + c] = v;
+            else          ((Sint16 *)stream)[i * noise_channels + c] = (Sint16)(v * 32767.0f);
+        }
+    }
+}
+
+// Helper: start the generator, fading in from silence
+static void start_noise(void) {
+    int freq;
+    Mix_QuerySpec(&freq, &noise_format, &noise_channels);
+    if (noise_format != AUDIO_S16SYS && noise_format != AUDIO_F32SYS) {
+        log_warn("Ambient noise needs 16-bit or float output");
+        return;
+    }
+    Mix_LockAudio();
+    noise_type = ambient;
+    noise_gain = 0.0f;
+    SDL_AtomicSet(&noise_request, ambient);
+    Mix_UnlockAudio();
+    Mix_HookMusic(ambient_noise_mixer, NULL);
+    noise_active = true;
+}
+
+void process_audio_events(void) {
+    int events = SDL_AtomicSet(&pending_events, 0);
+
+    // a track ended by itself: queue the next one, unless the session stopped the
+    // music meanwhile (stop_lofi's own halt also lands here, and is ignored)
+    if ((events & AUDIO_EVENT_MUSIC_FINISHED) && lofi_wanted &&
+        !noise_active && !Mix_PlayingMusic()) {
+        play_lofi();
+    }
+}
+
+int pick_lofi_track(void) {
+    if (lofi_count == 0) return -1;
 
     // Pick random track
     do {
@@ -177,16 +634,37 @@ void play_lofi(void) {
 
     recent_history[history_index] = current_index;
     history_index = (history_index + 1) % history_size;
+    return current_index;
+}
+
+void play_lofi(void) {
+    stop_lofi();
+    lofi_wanted = true;
+
+    if (ambient != AMBIENT_LOFI) {
+        start_noise();
+        return;
+    }
+
+    pick_lofi_track();
 
-    Mix_Music *m = Mix_LoadMUS(lofi_paths[current_index]);
+    // prefer the pre-decoded copy when the transcode cache has one
+    const char *path = transcode_cached_path(current_index, lofi_paths[current_index]);
+    TRACE_BEGIN("Mix_LoadMUS");
+    Mix_Music *m = Mix_LoadMUS(path);
+    TRACE_END("Mix_LoadMUS");
     if (!m) {
-        fprintf(stderr, "Mix_LoadMUS Error (%s): %s\n", lofi_paths[current_index], Mix_GetError());
+        log_error("Mix_LoadMUS Error (%s): %s", path, Mix_GetError());
         return;
     }
     current_music = m;
 
+    // level the track before it starts so there is no jump
+    track_gain = loudness_gain(current_index);
+    apply_music_volume();
+
     if (Mix_PlayMusic(current_music, 0) == -1) {
-        fprintf(stderr, "Mix_PlayMusic Error: %s\n", Mix_GetError());
+        log_error("Mix_PlayMusic Error: %s", Mix_GetError());
         return;
     }
 
@@ -194,6 +672,11 @@ void play_lofi(void) {
 }
 
 void stop_lofi(void) {
+    lofi_wanted = false;
+    if (noise_active) {
+        Mix_HookMusic(NULL, NULL);
+        noise_active = false;
+    }
     if (current_music) {
         Mix_HaltMusic();
         Mix_FreeMusic(current_music);
@@ -202,14 +685,30 @@ void stop_lofi(void) {
 }
 
 bool is_lofi_playing(void) {
-    return Mix_PlayingMusic() != 0;
+    return noise_active || Mix_PlayingMusic() != 0;
+}
+
+void cycle_ambient(void) {
+    AmbientType next = (ambient + 1) % AMBIENT_COUNT;
+    bool playing = is_lofi_playing();
+
+    ambient = next;
+    if (next != AMBIENT_LOFI) {
+        SDL_AtomicSet(&noise_request, next);
+    }
+    if (noise_active && next != AMBIENT_LOFI) {
+        return;  // noise to noise: the generator crossfades by itself
+    }
+    if (playing) play_lofi();
 }
 
 int play_alarm(void) {
     if (muted) return -1;
+    TRACE_BEGIN("play_alarm");
     stop_lofi();
-    alarm_channel = Mix_PlayChannel(-1, alarm_chunk, 0);
-    if (alarm_channel < 0) fprintf(stderr, "Mix_PlayChannel Error. alarm_channel < 0: %s\n", Mix_GetError());
+    alarm_channel = synth_alarm ? bell_synth_play() : Mix_PlayChannel(-1, alarm_chunk, 0);
+    TRACE_END("play_alarm");
+    if (alarm_channel < 0) log_error("Mix_PlayChannel Error. alarm_channel < 0: %s", Mix_GetError());
     return alarm_channel;
 }
 
@@ -226,7 +725,7 @@ void set_volume(int level) {
     if (level > MIX_MAX_VOLUME) level = MIX_MAX_VOLUME;
     current_volume = level;
     if (!muted) {
-        Mix_VolumeMusic(current_volume);
+        apply_music_volume();
         Mix_VolumeChunk(alarm_chunk, current_volume);
     }
 }
@@ -245,13 +744,8 @@ int get_volume_percent(void){
 
 void toggle_mute(void) {
     muted = !muted;
-    if (muted) {
-        Mix_VolumeMusic(0);
-        Mix_VolumeChunk(alarm_chunk, 0);
-    } else {
-        Mix_VolumeMusic(current_volume);
-        Mix_VolumeChunk(alarm_chunk, current_volume);
-    }
+    apply_music_volume();
+    Mix_VolumeChunk(alarm_chunk, muted ? 0 : current_volume);
 }
 
 bool is_muted(void) {
@@ -8,6 +8,24 @@
 #include <sys/stat.h>
 #include <errno.h>
 #include <unistd.h>
+#include <time.h>
+#include <dirent.h>
+#include <limits.h>
+#include <sys/resource.h>
+
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 33))
+#include <malloc.h>
+#define HAVE_MALLINFO2 1
+#endif
+
+#if defined(__APPLE__)
+#include <CoreFoundation/CoreFoundation.h>
+#include <IOKit/pwr_mgt/IOPMLib.h>
+#include <mach/mach.h>
+#include <malloc/malloc.h>
+#else
+#include <SDL.h>
+#endif
 
 // Get ~/Documents
 int platform_get_documents_dir(char *out, size_t out_sz) {
@@ -51,4 +69,174 @@ int platform_mkdir_p(const char *path) {
     return 0;
 }
 
+// Helper: read a clock as nanoseconds
+static uint64_t clock_ns(clockid_t id) {
+    struct timespec ts;
+    clock_gettime(id, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+// On macOS CLOCK_MONOTONIC already counts through sleep; CLOCK_UPTIME_RAW does not.
+#if defined(__APPLE__)
+#define MONOTONIC_CLOCK CLOCK_UPTIME_RAW
+#define BOOTTIME_CLOCK  CLOCK_MONOTONIC
+#else
+#define MONOTONIC_CLOCK CLOCK_MONOTONIC
+#define BOOTTIME_CLOCK  CLOCK_BOOTTIME
+#endif
+
+uint64_t platform_monotonic_ns(void) {
+    return clock_ns(MONOTONIC_CLOCK);
+}
+
+uint64_t platform_boottime_ns(void) {
+    return clock_ns(BOOTTIME_CLOCK);
+}
+
+int64_t platform_wall_ns(void) {
+    return (int64_t)clock_ns(CLOCK_REALTIME);
+}
+
+void platform_sleep_until_ns(uint64_t deadline_ns) {
+#if defined(__APPLE__)
+    // no clock_nanosleep: sleep the remaining time, re-checking after early wakeups
+    uint64_t now;
+    while ((now = platform_boottime_ns()) < deadline_ns) {
+        uint64_t left = deadline_ns - now;
+        struct timespec ts = { (time_t)(left / 1000000000ull), (long)(left % 1000000000ull) };
+        nanosleep(&ts, NULL);
+    }
+#else
+    // absolute deadline on the boot clock: no drift, and a suspend in between ends the sleep
+    struct timespec ts = { (time_t)(deadline_ns / 1000000000ull), (long)(deadline_ns % 1000000000ull) };
+    while (clock_nanosleep(BOOTTIME_CLOCK, TIMER_ABSTIME, &ts, NULL) == EINTR) {
+        // interrupted by a signal: go back to sleep until the same deadline
+    }
+#endif
+}
+
+uint64_t platform_thread_cpu_ns(void) {
+    return clock_ns(CLOCK_THREAD_CPUTIME_ID);
+}
+
+// Helper: sum the third field of /proc/self/task/*/schedstat (times each thread
+// was scheduled in). Threads that already exited are not counted, so `threads`
+// gets a fingerprint of the set summed over. -1 off Linux.
+static int64_t count_wakeups(uint64_t *threads) {
+    *threads = 0;
+#if defined(__linux__)
+    DIR *dir = opendir("/proc/self/task");
+    if (!dir) return -1;
+    int64_t total = 0;
+    struct dirent *ent;
+    while ((ent = readdir(dir)) != NULL) {
+        if (ent->d_name[0] == '.') continue;
+        // order-independent: the sum of a mixed hash of each thread id
+        *threads += (strtoull(ent->d_name, NULL, 10) + 1) * 0x9e3779b97f4a7c15ull;
+        char path[sizeof "/proc/self/task/" + NAME_MAX + sizeof "/schedstat"];
+        snprintf(path, sizeof(path), "/proc/self/task/%s/schedstat", ent->d_name);
+        FILE *f = fopen(path, "r");
+        if (!f) continue;
+        unsigned long long run_ns, wait_ns, slices;
+        if (fscanf(f, "%llu %llu %llu", &run_ns, &wait_ns, &slices) == 3) {
+            total += (int64_t)slices;
+        }
+        fclose(f);
+    }
+    closedir(dir);
+    return total;
+#else
+    return -1;
+#endif
+}
+
+int platform_process_usage(ProcessUsage *out) {
+    struct rusage ru;
+    if (getrusage(RUSAGE_SELF, &ru) != 0) return -1;
+    out->user_s               = ru.ru_utime.tv_sec + ru.ru_utime.tv_usec / 1e6;
+    out->system_s             = ru.ru_stime.tv_sec + ru.ru_stime.tv_usec / 1e6;
+    out->voluntary_switches   = ru.ru_nvcsw;
+    out->involuntary_switches = ru.ru_nivcsw;
+    out->wakeups              = count_wakeups(&out->wakeup_threads);
+#if defined(__APPLE__)
+    out->peak_rss_kb          = ru.ru_maxrss / 1024;  // bytes on macOS
+#else
+    out->peak_rss_kb          = ru.ru_maxrss;         // kilobytes on Linux
+#endif
+    return 0;
+}
+
+int platform_memory_usage(MemoryUsage *out) {
+    out->rss_kb = out->heap_used_kb = out->heap_free_kb = -1;
+#if defined(__APPLE__)
+    struct mach_task_basic_info info;
+    mach_msg_type_number_t count = MACH_TASK_BASIC_INFO_COUNT;
+    if (task_info(mach_task_self(), MACH_TASK_BASIC_INFO, (task_info_t)&info, &count) == KERN_SUCCESS) {
+        out->rss_kb = (int64_t)(info.resident_size / 1024);
+    }
+    malloc_statistics_t st;
+    malloc_zone_statistics(NULL, &st);  // all zones
+    out->heap_used_kb = (int64_t)(st.size_in_use / 1024);
+    out->heap_free_kb = (int64_t)((st.size_allocated - st.size_in_use) / 1024);
+#else
+    FILE *f = fopen("/proc/self/statm", "r");
+    if (f) {
+        unsigned long long size, resident;
+        if (fscanf(f, "%llu %llu", &size, &resident) == 2) {
+            out->rss_kb = (int64_t)(resident * (unsigned long long)sysconf(_SC_PAGESIZE) / 1024);
+        }
+        fclose(f);
+    }
+#if defined(HAVE_MALLINFO2)
+    struct mallinfo2 mi = mallinfo2();
+    out->heap_used_kb = (int64_t)((mi.uordblks + mi.hblkhd) / 1024);  // arena + mmapped blocks
+    out->heap_free_kb = (int64_t)(mi.fordblks / 1024);
+#endif
+#endif
+    return 0;
+}
+
+#if defined(__APPLE__)
+static IOPMAssertionID sleep_assertion = kIOPMNullAssertionID;
+
+int platform_inhibit_sleep(const char *reason) {
+    if (sleep_assertion != kIOPMNullAssertionID) return 0;
+
+    CFStringRef name = CFStringCreateWithCString(kCFAllocatorDefault, reason, kCFStringEncodingUTF8);
+    if (!name) return -1;
+    IOReturn rc = IOPMAssertionCreateWithName(kIOPMAssertionTypePreventSystemSleep,
+                                              kIOPMAssertionLevelOn, name, &sleep_assertion);
+    CFRelease(name);
+    if (rc != kIOReturnSuccess) {
+        sleep_assertion = kIOPMNullAssertionID;
+        return -1;
+    }
+    return 0;
+}
+
+void platform_release_sleep(void) {
+    if (sleep_assertion == kIOPMNullAssertionID) return;
+    IOPMAssertionRelease(sleep_assertion);
+    sleep_assertion = kIOPMNullAssertionID;
+}
+#else
+static int sleep_inhibited = 0;
+static int saver_was_enabled = 0;   // SDL's own setting before we touched it
+
+int platform_inhibit_sleep(const char *reason) {
+    (void)reason;  // SDL names the inhibitor after the application
+    if (sleep_inhibited) return 0;
+    saver_was_enabled = SDL_IsScreenSaverEnabled();
+    SDL_DisableScreenSaver();
+    sleep_inhibited = 1;
+    return 0;
+}
+
+void platform_release_sleep(void) {
+    if (!sleep_inhibited) return;
+    if (saver_was_enabled) SDL_EnableScreenSaver();
+    sleep_inhibited = 0;
+}
+#endif
+
 #endif
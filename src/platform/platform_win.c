@@ -4,6 +4,7 @@
 
 #include <windows.h>
 #include <shlobj.h>
+#include <psapi.h>
 #include <string.h>
 
 // Get Documents folder
@@ -82,4 +83,102 @@ int platform_mkdir_p(const char *path) {
     return 0;
 }
 
+uint64_t platform_monotonic_ns(void) {
+    // interrupt time without the time spent suspended, in 100 ns units
+    ULONGLONG t = 0;
+    QueryUnbiasedInterruptTime(&t);
+    return (uint64_t)t * 100;
+}
+
+uint64_t platform_boottime_ns(void) {
+    // QueryPerformanceCounter keeps counting through sleep on current Windows
+    LARGE_INTEGER freq, count;
+    QueryPerformanceFrequency(&freq);
+    QueryPerformanceCounter(&count);
+    return (uint64_t)(count.QuadPart / freq.QuadPart) * 1000000000ull
+         + (uint64_t)(count.QuadPart % freq.QuadPart) * 1000000000ull / freq.QuadPart;
+}
+
+int64_t platform_wall_ns(void) {
+    // FILETIME counts 100 ns since 1601-01-01
+    FILETIME ft;
+    GetSystemTimePreciseAsFileTime(&ft);
+    ULARGE_INTEGER t;
+    t.LowPart  = ft.dwLowDateTime;
+    t.HighPart = ft.dwHighDateTime;
+    return (int64_t)(t.QuadPart - 116444736000000000ull) * 100;
+}
+
+void platform_sleep_until_ns(uint64_t deadline_ns) {
+    uint64_t now;
+    while ((now = platform_boottime_ns()) < deadline_ns) {
+        DWORD ms = (DWORD)((deadline_ns - now + 999999) / 1000000);
+        Sleep(ms);
+    }
+}
+
+uint64_t platform_thread_cpu_ns(void) {
+    // kernel + user time, in 100 ns units
+    FILETIME created, exited, kernel, user;
+    if (!GetThreadTimes(GetCurrentThread(), &created, &exited, &kernel, &user)) return 0;
+    ULARGE_INTEGER k, u;
+    k.LowPart = kernel.dwLowDateTime; k.HighPart = kernel.dwHighDateTime;
+    u.LowPart = user.dwLowDateTime;   u.HighPart = user.dwHighDateTime;
+    return (k.QuadPart + u.QuadPart) * 100;
+}
+
+// Helper: FILETIME (100 ns units) as seconds
+static double filetime_s(FILETIME ft) {
+    ULARGE_INTEGER v;
+    v.LowPart = ft.dwLowDateTime; v.HighPart = ft.dwHighDateTime;
+    return v.QuadPart / 1e7;
+}
+
+int platform_process_usage(ProcessUsage *out) {
+    FILETIME created, exited, kernel, user;
+    if (!GetProcessTimes(GetCurrentProcess(), &created, &exited, &kernel, &user)) return -1;
+    out->user_s   = filetime_s(user);
+    out->system_s = filetime_s(kernel);
+
+    // Windows keeps no per-process context switch or wakeup counters
+    out->voluntary_switches   = -1;
+    out->involuntary_switches = -1;
+    out->wakeups              = -1;
+    out->wakeup_threads       = 0;
+
+    PROCESS_MEMORY_COUNTERS mem;
+    out->peak_rss_kb = GetProcessMemoryInfo(GetCurrentProcess(), &mem, sizeof(mem))
+        ? (int64_t)(mem.PeakWorkingSetSize / 1024) : -1;
+    return 0;
+}
+
+int platform_memory_usage(MemoryUsage *out) {
+    PROCESS_MEMORY_COUNTERS_EX mem;
+    if (!GetProcessMemoryInfo(GetCurrentProcess(), (PROCESS_MEMORY_COUNTERS *)&mem, sizeof(mem))) {
+        return -1;
+    }
+    out->rss_kb       = (int64_t)(mem.WorkingSetSize / 1024);
+    out->heap_used_kb = (int64_t)(mem.PrivateUsage / 1024);  // committed private memory
+    out->heap_free_kb = -1;                                  // the CRT heap keeps no total
+    return 0;
+}
+
+static int sleep_inhibited = 0;
+
+int platform_inhibit_sleep(const char *reason) {
+    (void)reason;  // SetThreadExecutionState takes no label
+    if (sleep_inhibited) return 0;
+    if (SetThreadExecutionState(ES_CONTINUOUS | ES_SYSTEM_REQUIRED) == 0) {
+        return -1;
+    }
+    sleep_inhibited = 1;
+    return 0;
+}
+
+void platform_release_sleep(void) {
+    if (!sleep_inhibited) return;
+    SetThreadExecutionState(ES_CONTINUOUS);
+    sleep_inhibited = 0;
+}
+
 #endif
@@ -1,149 +1,227 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <time.h>
-#include <unistd.h>
-#include <sys/time.h>
 
 #include "pomodoro.h"
 #include "settings.h"
 #include "graphics.h"
 #include "music.h"
-
-// Get current time in seconds with sub-second precision
+#include "visualizer.h"
+#include "timing.h"
+#include "logger.h"
+#include "timer_engine.h"
+#include "timefmt.h"
+#include "trace.h"
+#include "soak.h"
+#include "replay.h"
+
+#define ALARM_LEAD_SECONDS 2.0  // silence and the low-latency audio buffer this long before an alarm
+#define FRAME_MS            500  // redraw interval
+#define VISUALIZER_FRAME_MS  33  // redraw interval while the spectrum bars move
+#define EXTEND_SECONDS      300  // 'E' lengthens the running phase by this much
+
+// State of the SDL frontend while the engine runs a schedule
+typedef struct {
+    bool    music_started;
+    time_t *session_starts;  // work sessions, for the side panel
+    time_t *session_ends;
+    int     num_sessions;
+} Frontend;
+
+// Get current time in seconds with sub-second precision.
+// Boot-clock based (see timing.h): unaffected by clock changes, counts through suspend.
 double get_time_now(void) {
-    struct timeval tv;
-    gettimeofday(&tv, NULL);
-    return tv.tv_sec + tv.tv_usec / 1000000.0;
+    return timing_now();
 }
 
-// Run a timer until end_time, updating the graphics every 500ms
-// duration_seconds is the total length of the session in seconds
-int run_timer(double       end_time,
-               TimerType    type,
-               int          duration_seconds,
-               int          current_session,
-               const time_t *session_starts,
-               const time_t *session_ends,
-               int          num_sessions)
-{
-    bool music_started = false;
-    SDL_Event event;
-
-    while (1) {
-        // audio control
-        if (type == WORK){
-            // during work. play lofi except when alarm rings
-            if (is_alarm_playing()) {
-                stop_lofi();
-                music_started = false;
-            } else if (!music_started) {
-                play_lofi();
-                music_started = true;
-            }
-            track_scroll += 10; // move these pixels per tick. the higher the faster
-        } else {
-            // during break.
-            if (music_started) {
-                stop_lofi();
-            }
-            music_started = false;
+// Helper: audio for one frame of a phase
+static void update_audio(Frontend *fe, const TimerEvent *ev) {
+    if (ev->remaining <= ALARM_LEAD_SECONDS) {
+        // the last seconds of every phase are silent, so the device can be reopened
+        // for a prompt alarm without cutting anything off
+        if (fe->music_started) {
+            stop_lofi();
+            fe->music_started = false;
         }
-
-        // Handle window events to keep the window responsive
-        while (SDL_PollEvent(&event)) {
-            switch (event.type) {
-            case SDL_QUIT:
-                return 1;
-            case SDL_KEYDOWN:
-                if (event.key.keysym.sym == 'm' || event.key.keysym.sym == 'M') toggle_mute();
-                if (event.key.keysym.sym == '[') adjust_volume(-8);
-                if (event.key.keysym.sym == ']') adjust_volume(+8);
-            } 
+        set_audio_buffer_mode(AUDIO_BUFFER_ALARM);
+    } else if (ev->span->kind == TIMER_PHASE_WORK) {
+        // during work. play lofi except when alarm rings
+        if (is_alarm_playing()) {
+            stop_lofi();
+            fe->music_started = false;
+        } else if (!fe->music_started) {
+            set_audio_buffer_mode(AUDIO_BUFFER_MUSIC);
+            play_lofi();
+            fe->music_started = true;
         }
+        track_scroll += 10; // move these pixels per tick. the higher the faster
+    }
+}
 
-        double now = get_time_now();
-        double remaining = end_time - now;
-        if (remaining <= 0.0) {
-            remaining = 0.0;
+// Helper: draw one frame of a phase
+static void draw_frame(const Frontend *fe, const TimerEvent *ev) {
+    TimerType type = ev->span->kind == TIMER_PHASE_WORK ? WORK : BREAK;
+    bool lead_in = ev->span->session < 0;  // before the first session: no schedule panel
+
+    TRACE_BEGIN("draw_frame");
+    graphics_begin_frame();
+    draw_pie(ev->fraction, type);
+    draw_visualizer();
+    render_countdown((int)ev->remaining, type);
+    draw_panel(
+        (time_t)ev->now,                            // current time
+        ev->span->session,                          // current session
+        lead_in ? NULL : fe->session_starts,        // array
+        lead_in ? NULL : fe->session_ends,          // array
+        lead_in ? 0    : fe->num_sessions
+    );
+    graphics_end_frame();
+    TRACE_END("draw_frame");
+}
+
+// Engine listener: the SDL window and the speakers
+static void on_timer_event(const TimerEvent *ev, void *user) {
+    Frontend *fe = user;
+
+    switch (ev->type) {
+    case TIMER_EVENT_PHASE_START:
+        fe->music_started = false;
+        log_info("Phase: %s %d, %.0f min", ev->span->kind == TIMER_PHASE_WORK ? "work" : "break",
+                 ev->span->session + 1, (ev->span->end - ev->span->start) / 60.0);
+        break;
+    case TIMER_EVENT_TICK:
+        update_audio(fe, ev);
+        draw_frame(fe, ev);
+        break;
+    case TIMER_EVENT_PHASE_END:
+        if (ev->span->kind == TIMER_PHASE_WORK) {
+            stop_lofi();
+        }
+        break;
+    case TIMER_EVENT_ALARM:
+        // a string of alarms for phases slept through helps nobody
+        if (!ev->stale) {
+            play_alarm();
         }
+        break;
+    case TIMER_EVENT_DONE:
+        log_info("Phase: done");
+        break;
+    }
+}
 
-        // Compute fraction of time left
-        double fraction = remaining / (double)duration_seconds;
-        if (fraction < 0.0) fraction = 0.0;
-        if (fraction > 1.0) fraction = 1.0;
-
-        int seconds_left = (int)remaining;
-
-        // Draw frame
-        graphics_begin_frame();
-        draw_pie(fraction, type);
-        render_countdown(seconds_left, type);
-        draw_panel(
-            (time_t)time(NULL),      // current time
-            current_session,         // from run_pomodoro()
-            session_starts,          // array
-            session_ends,            // array
-            num_sessions
-        );
-        graphics_end_frame();
-
-        // Break loop when timer expires
-        if (remaining <= 0.0) {
-            break;
+// Helper: refresh the side panel's session times from the plan (after an edit)
+static void collect_sessions(Frontend *fe, const SchedulePlan *plan) {
+    for (int i = 0; i < plan->count; i++) {
+        const TimerPhaseSpan *phase = &plan->phases[i];
+        if (phase->kind == TIMER_PHASE_WORK) {
+            fe->session_starts[phase->session] = (time_t)phase->start;
+            fe->session_ends  [phase->session] = (time_t)phase->end;
         }
+    }
+}
 
-        SDL_Delay(500);
+// Helper: keep the window responsive. Returns 1 if the user closed it.
+static int handle_window_events(TimerEngine *engine, Frontend *fe, const SchedulePlan *plan) {
+    SDL_Event event;
+    while (replay_poll_event(&event)) {
+        switch (event.type) {
+        case SDL_QUIT:
+            return 1;
+        case SDL_KEYDOWN:
+            if (event.key.keysym.sym == 'm' || event.key.keysym.sym == 'M') toggle_mute();
+            if (event.key.keysym.sym == '[') adjust_volume(-8);
+            if (event.key.keysym.sym == ']') adjust_volume(+8);
+            if (event.key.keysym.sym == 'n' || event.key.keysym.sym == 'N') cycle_ambient();
+            if (event.key.keysym.sym == SDLK_F3) graphics_toggle_hud();
+            if (event.key.keysym.sym == 's' || event.key.keysym.sym == 'S') {
+                timer_engine_skip(engine);
+                collect_sessions(fe, plan);
+            }
+            if (event.key.keysym.sym == 'e' || event.key.keysym.sym == 'E') {
+                timer_engine_extend(engine, EXTEND_SECONDS);
+                collect_sessions(fe, plan);
+            }
+        }
     }
     return 0;
 }
 
+// --duration: the session clock time at which a run stops early; 0 = never
+static double time_limit = 0.0;
+
+void pomodoro_set_time_limit(double end_time) {
+    time_limit = end_time;
+}
+
 // Run full Pomodoro sequence based on settings
 int run_pomodoro(const Settings *settings, time_t base) {
     int n = settings->num_sessions;
+    if (n <= 0) return 0;
+
+    ScheduleSpec spec = {
+        settings->work_time * 60,
+        settings->break_time * 60,
+        settings->long_break_time * 60,
+        settings->long_break_every,
+        n
+    };
+
+    // a start time in the future begins with a break until then
+    SchedulePlan *plan = schedule_plan_create(&spec, get_time_now(), (double)base);
+    TimerEngine *engine = plan ? timer_engine_create(plan, NULL) : NULL;
+    if (!engine) {
+        log_error("Failed to create the timer engine");
+        schedule_plan_destroy(plan);
+        return 1;
+    }
+
     time_t session_starts[n];
     time_t session_ends[n];
+    Frontend fe = { false, session_starts, session_ends, n };
+    collect_sessions(&fe, plan);
+    timer_engine_subscribe(engine, on_timer_event, &fe);
+
+    int quit = 0;
+    while (!timer_engine_done(engine)) {
+        // react to mixer callbacks (track ended) here, on the main thread
+        TRACE_BEGIN("events");
+        process_audio_events();
+        soak_poll();   // --soak: queues its key presses before they are read
+        int stop = handle_window_events(engine, &fe, plan);
+        TRACE_END("events");
+        if (stop) {
+            quit = 1;  // premature exit
+            break;
+        }
 
-    // compute all session times in advance
-    session_starts[0] = base;
-    session_ends  [0] = base + settings->work_time * 60;
-
-    for (int session = 1; session < n; session++) {
-        session_starts[session] = session_ends[session-1] + settings->break_time * 60;
-        session_ends  [session] = session_starts[session] + settings->work_time * 60;
-    }
+        double gap = timing_suspend_gap();
+        if (gap > 0.0) {
+            log_info("Resumed after %.0f s of suspend", gap);
+            timefmt_invalidate();  // the machine may have changed timezone meanwhile
+        }
+        double moved = timing_check_wall();
+        if (moved != 0.0) {
+            log_info("Wall clock moved by %+.0f s; following it", moved);
+            timefmt_invalidate();
+        }
 
-    // actually running the sessions
-    for (int session = 0; session < n; session++) {
-        // Work session
-        if (run_timer(
-          (double)session_ends[session],  // end_time
-          WORK,                           // type
-          settings->work_time * 60,       // duration
-          session,                        // current_session
-          session_starts,                 // array of starts
-          session_ends,                   // array of ends
-          n                               // total sessions
-        ) == 1) return 1;  // Quit if run_timer returns 1, which means a premature exit
-
-        // stop the lofi and trigger alarm
-        stop_lofi();
-        play_alarm();
-
-        // Break (except after the last session)
-        if (session < n-1) {
-            if(run_timer(
-              (double)(session_ends[session] + settings->break_time*60),
-              BREAK,
-              settings->break_time * 60,
-              session,
-              session_starts,
-              session_ends,
-              n
-            ) == 1) return 1; // Quit prematurely
-            play_alarm();
+        // redraw faster while the spectrum bars move
+        timer_engine_set_tick(engine,
+            (visualizer_active() && is_lofi_playing() ? VISUALIZER_FRAME_MS : FRAME_MS) / 1000.0);
+
+        // sleep to the next frame boundary of the clock itself, so the seconds tick evenly
+        TRACE_BEGIN("engine_poll");
+        double deadline = timer_engine_poll(engine);   // ticks draw from in here
+        TRACE_END("engine_poll");
+        if (time_limit > 0.0) {
+            if (get_time_now() >= time_limit) break;
+            if (deadline > time_limit) deadline = time_limit;
         }
+        timing_sleep_until(deadline);
     }
 
-    // Successfully completed
-    return 0;
+    timer_engine_destroy(engine);
+    schedule_plan_destroy(plan);
+    return quit;
 }
@@ -0,0 +1,358 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include <SDL.h>
+
+#include "replay.h"
+#include "timing.h"
+#include "graphics.h"
+#include "platform.h"
+#include "logger.h"
+
+// File: "SWRP", a version byte, varint width and height, the settings JSON (varint
+// length, then the text), then records. Numbers are LEB128 varints, signed ones
+// zigzag-coded, so a clock reading costs 2-4 bytes.
+#define MAGIC      "SWRP"
+#define VERSION    2
+#define REC_CLOCK  'c'   // microseconds since the previous reading
+#define REC_EVENT  'e'   // event type, then the fields the app reads (see write_event)
+
+typedef enum { REPLAY_OFF, REPLAY_RECORDING, REPLAY_PLAYING } ReplayMode;
+
+typedef struct {
+    SDL_Event event;
+    int64_t   at_us;   // clock reading before the app consumed it
+    int       seq;     // number of clock readings before it
+} ReplayEvent;
+
+typedef struct {
+    const unsigned char *p, *end;
+    int bad;
+} Reader;
+
+static ReplayMode mode = REPLAY_OFF;
+
+// recording
+static FILE              *out = NULL;
+static const char        *out_path = NULL;
+static const TimingClock *inner = NULL;   // the clock being recorded
+static int                inner_virtual = 0;
+static TimingClock        record_clock;
+static int64_t            last_us = 0;
+
+// replay
+static int64_t     *clocks = NULL;
+static int          clock_count = 0;
+static int          clock_next  = 0;
+static ReplayEvent *events = NULL;
+static int          event_count = 0;
+static int          event_next  = 0;
+static int64_t      now_us  = 0;
+static int          used_up = 0;          // the app read past the last clock reading
+static int          rec_width = 0, rec_height = 0;
+static char        *rec_settings = NULL;  // NULL when the recording carries none
+static TimingClock  play_clock;
+static uint64_t     play_cpu_ns, play_wall_ns;
+
+static uint64_t zigzag(int64_t v) {
+    return ((uint64_t)v << 1) ^ (uint64_t)(v >> 63);
+}
+
+static int64_t unzigzag(uint64_t v) {
+    return (int64_t)(v >> 1) ^ -(int64_t)(v & 1);
+}
+
+static void put_varint(uint64_t v) {
+    while (v >= 0x80) {
+        fputc((int)(v & 0x7f) | 0x80, out);
+        v >>= 7;
+    }
+    fputc((int)v, out);
+}
+
+static uint64_t get_varint(Reader *r) {
+    uint64_t v = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+        if (r->p >= r->end) break;
+        unsigned char b = *r->p++;
+        v |= (uint64_t)(b & 0x7f) << shift;
+        if (!(b & 0x80)) return v;
+    }
+    r->bad = 1;
+    return 0;
+}
+
+// ---- recording ----
+
+static double record_now(void *ctx) {
+    (void)ctx;
+    int64_t us = (int64_t)llround(inner->now(inner->ctx) * 1e6);
+    fputc(REC_CLOCK, out);
+    put_varint(zigzag(us - last_us));
+    last_us = us;
+    return us / 1e6;  // exactly what replay will return
+}
+
+static void record_sleep_until(void *ctx, double deadline) {
+    (void)ctx;
+    inner->sleep_until(inner->ctx, deadline);
+}
+
+static void write_event(const SDL_Event *e) {
+    // drops carry heap strings, and the app ignores them
+    if (e->type == SDL_DROPFILE || e->type == SDL_DROPTEXT) return;
+
+    fputc(REC_EVENT, out);
+    put_varint(e->type);
+    switch (e->type) {
+    case SDL_KEYDOWN:
+    case SDL_KEYUP:
+        put_varint(zigzag(e->key.keysym.sym));
+        put_varint(e->key.keysym.mod);
+        put_varint(e->key.keysym.scancode);
+        put_varint(e->key.repeat);
+        break;
+    case SDL_TEXTINPUT: {
+        size_t len = strlen(e->text.text);
+        put_varint(len);
+        fwrite(e->text.text, 1, len, out);
+        break;
+    }
+    case SDL_WINDOWEVENT:
+        put_varint(e->window.event);
+        put_varint(zigzag(e->window.data1));
+        put_varint(zigzag(e->window.data2));
+        break;
+    default:
+        break;  // the type is all the app looks at
+    }
+}
+
+int replay_record_begin(const char *path, int width, int height, const char *settings_json) {
+    out = fopen(path, "wb");
+    if (!out) return 1;
+    out_path = path;
+    fwrite(MAGIC, 1, 4, out);
+    fputc(VERSION, out);
+    put_varint((uint64_t)width);
+    put_varint((uint64_t)height);
+    size_t len = settings_json ? strlen(settings_json) : 0;
+    put_varint(len);
+    fwrite(settings_json ? settings_json : "", 1, len, out);
+
+    inner_virtual = timing_is_virtual();
+    inner = timing_current_clock();
+    record_clock.now         = record_now;
+    record_clock.sleep_until = record_sleep_until;
+    record_clock.ctx         = NULL;
+    timing_set_clock(&record_clock);
+    mode = REPLAY_RECORDING;
+    return 0;
+}
+
+// ---- replay ----
+
+static double play_now(void *ctx) {
+    (void)ctx;
+    if (clock_next < clock_count) {
+        now_us = clocks[clock_next++];
+    } else {
+        used_up = 1;
+    }
+    return now_us / 1e6;
+}
+
+// The recorded run woke at or after `deadline`. Skipping to there keeps a build that
+// reads the clock more or less often than the recorded one in step.
+static void play_sleep_until(void *ctx, double deadline) {
+    (void)ctx;
+    int64_t d = (int64_t)floor(deadline * 1e6);
+    while (clock_next < clock_count && clocks[clock_next] < d) {
+        clock_next++;
+    }
+}
+
+// Helper: decode one event record; 0 on a malformed one
+static int read_event(Reader *r, SDL_Event *e) {
+    SDL_zero(*e);
+    e->type = (Uint32)get_varint(r);
+    switch (e->type) {
+    case SDL_KEYDOWN:
+    case SDL_KEYUP:
+        e->key.state        = e->type == SDL_KEYDOWN ? SDL_PRESSED : SDL_RELEASED;
+        e->key.keysym.sym   = (SDL_Keycode)unzigzag(get_varint(r));
+        e->key.keysym.mod   = (Uint16)get_varint(r);
+        e->key.keysym.scancode = (SDL_Scancode)get_varint(r);
+        e->key.repeat       = (Uint8)get_varint(r);
+        break;
+    case SDL_TEXTINPUT: {
+        uint64_t len = get_varint(r);
+        if (len >= sizeof(e->text.text) || len > (uint64_t)(r->end - r->p)) return 0;
+        memcpy(e->text.text, r->p, len);
+        r->p += len;
+        break;
+    }
+    case SDL_WINDOWEVENT:
+        e->window.event = (Uint8)get_varint(r);
+        e->window.data1 = (Sint32)unzigzag(get_varint(r));
+        e->window.data2 = (Sint32)unzigzag(get_varint(r));
+        break;
+    default:
+        break;
+    }
+    return !r->bad;
+}
+
+// Helper: split the records into clock readings and events
+static int parse_recording(const unsigned char *data, size_t size) {
+    Reader r = { data, data + size, 0 };
+    if (size < 5 || memcmp(data, MAGIC, 4) != 0 || data[4] != VERSION) return 1;
+    r.p += 5;
+    rec_width  = (int)get_varint(&r);
+    rec_height = (int)get_varint(&r);
+    uint64_t len = get_varint(&r);
+    if (r.bad || len > (uint64_t)(r.end - r.p)) return 1;
+    if (len > 0) {
+        rec_settings = malloc(len + 1);
+        if (!rec_settings) return 1;
+        memcpy(rec_settings, r.p, len);
+        rec_settings[len] = '\0';
+        r.p += len;
+    }
+
+    int clock_cap = 0, event_cap = 0;
+    int64_t us = 0;
+    while (r.p < r.end && !r.bad) {
+        unsigned char tag = *r.p++;
+        if (tag == REC_CLOCK) {
+            int64_t delta = unzigzag(get_varint(&r));
+            if (r.bad) break;
+            us += delta;
+            if (clock_count == clock_cap) {
+                clock_cap = clock_cap ? clock_cap * 2 : 4096;
+                int64_t *grown = realloc(clocks, sizeof(int64_t) * clock_cap);
+                if (!grown) return 1;
+                clocks = grown;
+            }
+            clocks[clock_count++] = us;
+        } else if (tag == REC_EVENT) {
+            if (event_count == event_cap) {
+                event_cap = event_cap ? event_cap * 2 : 256;
+                ReplayEvent *grown = realloc(events, sizeof(ReplayEvent) * event_cap);
+                if (!grown) return 1;
+                events = grown;
+            }
+            ReplayEvent *ev = &events[event_count];
+            if (!read_event(&r, &ev->event)) {
+                r.bad = 1;
+                break;
+            }
+            ev->at_us = us;
+            ev->seq   = clock_count;
+            event_count++;
+        } else {
+            r.bad = 1;
+        }
+    }
+    // a recording cut short (the app crashed) still replays up to the damage
+    if (r.bad) log_warn("Replay: recording is damaged after %d clock readings", clock_count);
+    return clock_count == 0;
+}
+
+int replay_load(const char *path) {
+    FILE *f = fopen(path, "rb");
+    if (!f) return 1;
+    fseek(f, 0, SEEK_END);
+    long size = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    unsigned char *data = malloc(size > 0 ? size : 1);
+    size_t got = data ? fread(data, 1, size, f) : 0;
+    fclose(f);
+
+    int rc = data ? parse_recording(data, got) : 1;
+    free(data);
+    if (rc == 0) log_info("Replaying %s: %d clock readings, %d events", path, clock_count, event_count);
+    return rc;
+}
+
+const char *replay_settings(void) {
+    return rec_settings;
+}
+
+void replay_play_begin(void) {
+    play_clock.now         = play_now;
+    play_clock.sleep_until = play_sleep_until;
+    play_clock.ctx         = NULL;
+    timing_set_clock(&play_clock);
+    mode = REPLAY_PLAYING;
+    play_cpu_ns  = platform_thread_cpu_ns();
+    play_wall_ns = platform_monotonic_ns();
+}
+
+int replay_playing(void) {
+    return mode == REPLAY_PLAYING;
+}
+
+void replay_window_size(int *width, int *height) {
+    *width  = rec_width;
+    *height = rec_height;
+}
+
+int replay_poll_event(SDL_Event *e) {
+    if (mode != REPLAY_PLAYING) {
+        int got = SDL_PollEvent(e);
+        if (got && mode == REPLAY_RECORDING) write_event(e);
+        return got;
+    }
+
+    // live input is ignored, except a quit (Ctrl-C)
+    while (SDL_PollEvent(e)) {
+        if (e->type == SDL_QUIT) return 1;
+    }
+    // due once the clock was read as often as when it was recorded, or has moved
+    // past that reading (a build that reads the clock less often)
+    if (event_next < event_count) {
+        const ReplayEvent *ev = &events[event_next];
+        if ((clock_next >= ev->seq && now_us >= ev->at_us) || now_us > ev->at_us) {
+            *e = ev->event;
+            event_next++;
+            return 1;
+        }
+    }
+    if (used_up) {
+        SDL_zero(*e);
+        e->type = SDL_QUIT;
+        return 1;
+    }
+    return 0;
+}
+
+void replay_finish(void) {
+    if (mode == REPLAY_RECORDING) {
+        fclose(out);
+        out = NULL;
+        timing_set_clock(inner_virtual ? inner : NULL);  // later readings go unrecorded
+        log_info("Input recorded to %s", out_path);
+    } else if (mode == REPLAY_PLAYING) {
+        long long frames;
+        double p50, p99, max;
+        graphics_frame_summary(&frames, &p50, &p99, &max);
+        double cpu  = (platform_thread_cpu_ns() - play_cpu_ns) / 1e9;
+        double wall = (platform_monotonic_ns() - play_wall_ns) / 1e9;
+        printf("replay: %lld frames  p50 %.2f ms  p99 %.2f ms  max %.2f ms  main cpu %.2f s  wall %.2f s\n",
+               frames, p50, p99, max, cpu, wall);
+        if (event_next < event_count) {
+            log_warn("Replay: %d recorded events were never consumed; this build took another path",
+                     event_count - event_next);
+        }
+        free(clocks);
+        free(events);
+        free(rec_settings);
+        clocks = NULL;
+        events = NULL;
+        rec_settings = NULL;
+    }
+    mode = REPLAY_OFF;
+}
@@ -0,0 +1,89 @@
+#include <stdlib.h>
+
+#include "schedule.h"
+
+SchedulePlan *schedule_plan_create(const ScheduleSpec *spec, double lead_in_from, double base) {
+    if (!spec || spec->sessions < 0) return NULL;
+
+    SchedulePlan *plan = calloc(1, sizeof(*plan));
+    if (!plan) return NULL;
+
+    // lead-in + one work phase per session + the breaks between them
+    int max = 1 + 2 * spec->sessions;
+    plan->phases = malloc(sizeof(*plan->phases) * max);
+    if (!plan->phases) {
+        free(plan);
+        return NULL;
+    }
+
+    int n = 0;
+    if (lead_in_from < base) {
+        plan->phases[n++] = (TimerPhaseSpan){ lead_in_from, base, TIMER_PHASE_BREAK, -1 };
+    }
+
+    double t = base;
+    for (int session = 0; session < spec->sessions; session++) {
+        plan->phases[n++] = (TimerPhaseSpan){ t, t + spec->work_seconds, TIMER_PHASE_WORK, session };
+        t += spec->work_seconds;
+
+        // no break after the last session
+        if (session < spec->sessions - 1) {
+            int is_long = spec->long_break_every > 0 &&
+                          (session + 1) % spec->long_break_every == 0;
+            int length  = is_long ? spec->long_break_seconds : spec->break_seconds;
+            plan->phases[n++] = (TimerPhaseSpan){ t, t + length, TIMER_PHASE_BREAK, session };
+            t += length;
+        }
+    }
+    plan->count = n;
+    return plan;
+}
+
+void schedule_plan_destroy(SchedulePlan *plan) {
+    if (!plan) return;
+    free(plan->phases);
+    free(plan);
+}
+
+int schedule_plan_find(const SchedulePlan *plan, double t) {
+    if (plan->count == 0 || t < plan->phases[0].start) return -1;
+
+    // last phase starting at or before t
+    int lo = 0, hi = plan->count - 1;
+    while (lo < hi) {
+        int mid = lo + (hi - lo + 1) / 2;
+        if (plan->phases[mid].start <= t) lo = mid;
+        else hi = mid - 1;
+    }
+
+    // skipped phases are empty; step past them
+    while (lo < plan->count && t >= plan->phases[lo].end) lo++;
+    return lo;
+}
+
+int schedule_plan_set_end(SchedulePlan *plan, int index, double end) {
+    if (index < 0 || index >= plan->count) return -1;
+
+    TimerPhaseSpan *phase = &plan->phases[index];
+    if (end < phase->start) end = phase->start;
+
+    // phases are contiguous, so everything after the change point moves together
+    double delta = end - phase->end;
+    phase->end = end;
+    for (int i = index + 1; i < plan->count; i++) {
+        plan->phases[i].start += delta;
+        plan->phases[i].end   += delta;
+    }
+    return 0;
+}
+
+int schedule_plan_skip(SchedulePlan *plan, int index, double now) {
+    if (index < 0 || index >= plan->count) return -1;
+    if (now >= plan->phases[index].end) return 0;  // already over
+    return schedule_plan_set_end(plan, index, now);
+}
+
+int schedule_plan_extend(SchedulePlan *plan, int index, double seconds) {
+    if (index < 0 || index >= plan->count) return -1;
+    return schedule_plan_set_end(plan, index, plan->phases[index].end + seconds);
+}
@@ -6,6 +6,7 @@
 #include "platform.h"  // for platform-dependent file io
 #include "cJSON.h"
 #include "settings.h"
+#include "logger.h"
 #include "bell1_mp3_data.h"
 
 
@@ -16,6 +17,10 @@ static char settings_path[MAX_PATH_LEN];       // variable for settings path
 
 // ensure bell.mp3 exists
 static void ensure_bell_sound_exists(const Settings *settings) {
+    if (settings->alarm_synth[0] != '\0') {
+        // The synthesized alarm needs no file
+        return;
+    }
     if (settings->asset_directory[0] == '\0' ||
         settings->alarm_sound[0] == '\0') {
         // Nothing to do if paths in settings.json are empty
@@ -28,7 +33,7 @@ static void ensure_bell_sound_exists(const Settings *settings) {
     snprintf(dir_path, sizeof(dir_path), "%s", settings->asset_directory);
 
     if (platform_mkdir_p(dir_path) != 0) {
-        fprintf(stderr, "Failed to create asset directory: %s\n", dir_path);
+        log_error("Failed to create asset directory: %s", dir_path);
         return;
     }
 
@@ -44,7 +49,7 @@ static void ensure_bell_sound_exists(const Settings *settings) {
     // 4) Create and write the embedded MP3
     f = fopen(path, "wb");
     if (!f) {
-        fprintf(stderr, "Error creating alarm sound: %s\n", path);
+        log_error("Error creating alarm sound: %s", path);
         return;
     }
 
@@ -52,8 +57,8 @@ static void ensure_bell_sound_exists(const Settings *settings) {
                             (size_t)resources_bell1_mp3_len, f);
 
     if (written != (size_t)resources_bell1_mp3_len) {
-        fprintf(stderr,
-                "Short write when creating alarm sound (%zu/%u bytes): %s\n",
+        log_error(
+                "Short write when creating alarm sound (%zu/%u bytes): %s",
                 written, resources_bell1_mp3_len, path);
     }
 
@@ -103,7 +108,7 @@ void initialize_resource_directory(void) {
 
     // to create resource directory in the correct place, we need to locate Documents first
     if (platform_get_documents_dir(docs, sizeof(docs)) != 0) {
-        fprintf(stderr, "Failed to locate Documents directory\n");
+        log_error("Failed to locate Documents directory");
         exit(1);
     }
 
@@ -116,7 +121,7 @@ void initialize_resource_directory(void) {
          "%s%csound%clofi", resource_directory, PLATFORM_PATH_SEP, PLATFORM_PATH_SEP);
 
     if (platform_mkdir_p(lofi_directory) != 0) {
-        fprintf(stderr, "Failed to create resource or lofi directory: %s\n",
+        log_error("Failed to create resource or lofi directory: %s",
                 lofi_directory);
         exit(1);
     }
@@ -141,7 +146,7 @@ void create_default_settings(void) {
 
     FILE *file = fopen(settings_path, "w");
     if (file == NULL) {
-        fprintf(stderr, "Error creating settings file: %s\n", settings_path);
+        log_error("Error creating settings file: %s", settings_path);
         exit(1);
     }
 
@@ -158,74 +163,117 @@ void create_default_settings(void) {
     fprintf(file, "  \"work_time\": 50,\n");
     fprintf(file, "  \"break_time\": 10,\n");
     fprintf(file, "  \"num_sessions\": 5,\n");
+    fprintf(file, "  \"long_break_time\": 20,\n");
+    fprintf(file, "  \"long_break_every\": 0,\n");
     fprintf(file, "  \"width\": 800,\n");
     fprintf(file, "  \"height\": 500,\n");
     fprintf(file, "  \"asset_directory\": \"%s\",\n", asset_directory_json);
     fprintf(file, "  \"music_directory\": \"lofi\",\n");
+    fprintf(file, "  \"ambient\": \"lofi\",\n");
     fprintf(file, "  \"alarm_sound\": \"bell1.mp3\",\n");
-    fprintf(file, "  \"lid_con\": 0\n");
+    fprintf(file, "  \"alarm_synth\": \"\",\n");
+    fprintf(file, "  \"lid_con\": 0,\n");
+    fprintf(file, "  \"transcode_cache\": 0,\n");
+    fprintf(file, "  \"normalize_loudness\": 0,\n");
+    fprintf(file, "  \"visualizer\": 0,\n");
+    fprintf(file, "  \"log_file\": 0\n");
     fprintf(file, "}\n");
 
     fclose(file);
-    printf("Default settings file created at: %s\n", settings_path);
+    log_info("Default settings file created at: %s", settings_path);
 }
 
-// Load the settings from the JSON file
-Settings load_settings(void) {
+// Read the settings file into a string, NULL if it cannot be opened
+char *read_settings_text(void) {
     // if settings path is not specified yet, initialize
     if (settings_path[0] == '\0'){
         decide_settings_json_path();
     }
 
-    Settings settings;
     FILE *file = fopen(settings_path, "r");
-
-    if (file == NULL) {
-        printf("Error opening settings file. Creating default settings...\n");
-        create_default_settings();
-        file = fopen(settings_path, "r");  // Open again after creation
-        if (file == NULL) {
-            printf("Still can't open settings file."); // if file is still NULL just exist
-            exit(1);
-        }
-    }
+    if (file == NULL) return NULL;
 
     fseek(file, 0, SEEK_END);
     long file_size = ftell(file);
     fseek(file, 0, SEEK_SET);
 
     char *buffer = (char *)malloc(file_size + 1);
-    fread(buffer, 1, file_size, file);
+    if (buffer == NULL) {
+        fclose(file);
+        return NULL;
+    }
+    size_t got = fread(buffer, 1, file_size, file);
     fclose(file);
 
-    buffer[file_size] = '\0';  // Null-terminate the buffer
+    buffer[got] = '\0';  // Null-terminate the buffer
+    return buffer;
+}
 
-    // Parse the JSON data
-    cJSON *json = cJSON_Parse(buffer);
+// Load the settings from the JSON file
+Settings load_settings(void) {
+    char *buffer = read_settings_text();
+
+    if (buffer == NULL) {
+        log_warn("Error opening settings file. Creating default settings...");
+        create_default_settings();
+        buffer = read_settings_text();  // Open again after creation
+        if (buffer == NULL) {
+            log_error("Still can't open settings file."); // if file is still NULL just exist
+            exit(1);
+        }
+    }
+
+    Settings settings;
+    int failed = parse_settings(buffer, &settings);
     free(buffer);
 
-    if (json == NULL) {
-        printf("Error parsing settings file.\n");
+    if (failed) {
+        log_error("Error parsing settings file.");
         exit(1);
     }
 
+    // ensure a bell sound exists. if not, build the default bell1.mp3
+    ensure_bell_sound_exists(&settings);
+    return settings;
+}
+
+// Fill `out` from settings JSON; missing keys get their defaults
+int parse_settings(const char *text, Settings *out) {
+    cJSON *json = cJSON_Parse(text);
+    if (json == NULL) return 1;
+    Settings settings;
+
     // Extract the values
     cJSON *work_time = cJSON_GetObjectItem(json, "work_time");
     cJSON *break_time = cJSON_GetObjectItem(json, "break_time");
     cJSON *num_sessions = cJSON_GetObjectItem(json, "num_sessions");
+    cJSON *long_break_time = cJSON_GetObjectItem(json, "long_break_time");
+    cJSON *long_break_every = cJSON_GetObjectItem(json, "long_break_every");
     cJSON *width = cJSON_GetObjectItem(json, "width");
     cJSON *height = cJSON_GetObjectItem(json, "height");
     cJSON *asset_directory = cJSON_GetObjectItem(json, "asset_directory");
     cJSON *music_directory = cJSON_GetObjectItem(json, "music_directory");
     cJSON *alarm_sound = cJSON_GetObjectItem(json, "alarm_sound");
     cJSON *lid_con = cJSON_GetObjectItem(json, "lid_con");
+    cJSON *transcode_cache = cJSON_GetObjectItem(json, "transcode_cache");
+    cJSON *normalize_loudness = cJSON_GetObjectItem(json, "normalize_loudness");
+    cJSON *alarm_synth = cJSON_GetObjectItem(json, "alarm_synth");
+    cJSON *ambient = cJSON_GetObjectItem(json, "ambient");
+    cJSON *visualizer = cJSON_GetObjectItem(json, "visualizer");
+    cJSON *log_file = cJSON_GetObjectItem(json, "log_file");
 
     settings.work_time = work_time ? work_time->valueint : 50;  // Default to 50 if not found
     settings.break_time = break_time ? break_time->valueint : 10;  // Default to 10 if not found
     settings.num_sessions = num_sessions ? num_sessions->valueint : 5;  // Default to 5 if not found
+    settings.long_break_time = long_break_time ? long_break_time->valueint : 20;  // Default to 20 if not found
+    settings.long_break_every = long_break_every ? long_break_every->valueint : 0;  // Default to 0 (no long breaks)
     settings.width = width ? width->valueint : 800;  // Default to 800 if not found
     settings.height = height ? height->valueint : 500;  // Default to 500 if not found
     settings.lid_con = lid_con ? lid_con->valueint : 0;  // Default to 0 if not found
+    settings.transcode_cache = transcode_cache ? transcode_cache->valueint : 0;  // Default to 0 (off)
+    settings.normalize_loudness = normalize_loudness ? normalize_loudness->valueint : 0;  // Default to 0 (off: analysing decodes the whole library)
+    settings.visualizer = visualizer ? visualizer->valueint : 0;  // Default to 0 (off)
+    settings.log_file = log_file ? log_file->valueint : 0;  // Default to 0 (stderr only)
     if (asset_directory && cJSON_IsString(asset_directory)) {
         strncpy(settings.asset_directory,
                 asset_directory->valuestring,
@@ -256,9 +304,19 @@ Settings load_settings(void) {
         strncpy(settings.alarm_sound, "", MAX_PATH_LEN);
     }
 
-    // ensure a bell sound exists. if not, build the default bell1.mp3
-    ensure_bell_sound_exists(&settings);
+    // Synthesized alarm preset ("bell", "chime", "bowl"); empty means play alarm_sound
+    if (alarm_synth && cJSON_IsString(alarm_synth)) {
+        snprintf(settings.alarm_synth, sizeof(settings.alarm_synth), "%s",
+                 alarm_synth->valuestring);
+    } else {
+        settings.alarm_synth[0] = '\0';
+    }
+
+    // Work-session sound: "lofi", "white", "pink", "brown" or "rain"
+    snprintf(settings.ambient, sizeof(settings.ambient), "%s",
+             (ambient && cJSON_IsString(ambient)) ? ambient->valuestring : "lofi");
 
     cJSON_Delete(json);
-    return settings;
+    *out = settings;
+    return 0;
 }
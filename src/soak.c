@@ -0,0 +1,190 @@
+#include <stdio.h>
+#include <stddef.h>
+
+#include <SDL.h>
+
+#include "soak.h"
+#include "platform.h"
+#include "timing.h"
+#include "music.h"
+#include "graphics.h"
+#include "logger.h"
+
+// on the session clock, which a soak run usually steps or speeds up
+#define KEY_EVERY_S      37.0           // one key press from `keys`
+#define TRACK_EVERY_S    120.0          // another track while one plays
+#define ALARM_EVERY_S    (20 * 60.0)    // an extra alarm, besides the schedule's own
+#define MESSAGE_EVERY_S  3600.0         // the error screen, dismissed at once
+#define SAMPLE_EVERY_S   600.0
+#define WARMUP_S         (2 * 3600.0)   // caches and atlases fill up; not judged
+#define MAX_SAMPLES      2048           // 14 simulated days at one per 10 minutes
+#define WINDOWS          4
+
+typedef struct {
+    double      hours;   // since soak_begin()
+    MemoryUsage mem;
+} SoakSample;
+
+// What a soak run fails on, and by how much it may grow in total
+typedef struct {
+    const char *name;
+    size_t      offset;  // of the counter in MemoryUsage
+    int64_t     slack_kb;
+} SoakMetric;
+
+static const SoakMetric metrics[] = {
+    { "rss",       offsetof(MemoryUsage, rss_kb),       4096 },
+    { "heap_used", offsetof(MemoryUsage, heap_used_kb), 1024 },
+    { "heap_free", offsetof(MemoryUsage, heap_free_kb), 4096 },  // fragmentation
+};
+
+// volume, mute, ambient and skip, through the same event path as the keyboard
+static const SDL_Keycode keys[] = { ']', '[', 'm', 'm', 'n', '[', ']', 's' };
+
+static int         active = 0;
+static const char *out_path = NULL;
+static double      start;
+static double      next_key, next_track, next_alarm, next_message, next_sample;
+static int         key_index = 0;
+static SoakSample  samples[MAX_SAMPLES];
+static int         sample_count = 0;
+
+// Helper: queue a key press for the session loop
+static void press_key(SDL_Keycode key) {
+    SDL_Event e;
+    SDL_zero(e);
+    e.type = SDL_KEYDOWN;
+    e.key.keysym.sym = key;
+    SDL_PushEvent(&e);
+}
+
+static void take_sample(double now) {
+    if (sample_count == MAX_SAMPLES) {
+        log_warn("Soak: sample buffer full, later samples are dropped");
+        sample_count++;  // warn once
+        return;
+    }
+    if (sample_count > MAX_SAMPLES) return;
+
+    SoakSample *s = &samples[sample_count];
+    if (platform_memory_usage(&s->mem) != 0) return;
+    s->hours = (now - start) / 3600.0;
+    sample_count++;
+}
+
+void soak_begin(const char *samples_path) {
+    out_path     = samples_path;
+    start        = timing_now();
+    next_key     = start + KEY_EVERY_S;
+    next_track   = start + TRACK_EVERY_S;
+    next_alarm   = start + ALARM_EVERY_S;
+    next_message = start + MESSAGE_EVERY_S;
+    next_sample  = start;
+    key_index    = 0;
+    sample_count = 0;
+    active = 1;
+}
+
+int soak_active(void) {
+    return active;
+}
+
+void soak_poll(void) {
+    if (!active) return;
+    double now = timing_now();
+
+    if (now >= next_sample) {
+        take_sample(now);
+        next_sample = now + SAMPLE_EVERY_S;
+    }
+    // first, so the Enter meant for it is the only event it sees
+    if (now >= next_message) {
+        press_key(SDLK_RETURN);
+        show_fullscreen_message("Soak test: this screen closes by itself.");
+        next_message = now + MESSAGE_EVERY_S;
+    }
+    if (now >= next_key) {
+        press_key(keys[key_index]);
+        key_index = (key_index + 1) % (int)(sizeof(keys) / sizeof(keys[0]));
+        next_key = now + KEY_EVERY_S;
+    }
+    if (now >= next_track) {
+        if (is_lofi_playing()) play_lofi();  // breaks stay silent
+        next_track = now + TRACK_EVERY_S;
+    }
+    if (now >= next_alarm) {
+        play_alarm();
+        next_alarm = now + ALARM_EVERY_S;
+    }
+}
+
+static int64_t metric_value(const SoakSample *s, const SoakMetric *m) {
+    return *(const int64_t *)((const char *)&s->mem + m->offset);
+}
+
+// Helper: 1 when the metric rose from window to window after the warm-up and by
+// more than its slack overall. Each window counts with its minimum: a transient
+// peak (a track being decoded) does not count, memory that never comes back does.
+static int metric_grew(const SoakMetric *m, int first, int count) {
+    int64_t low[WINDOWS];
+    for (int w = 0; w < WINDOWS; w++) {
+        int begin = first + w * count / WINDOWS;
+        int end   = first + (w + 1) * count / WINDOWS;
+        low[w] = -1;
+        for (int i = begin; i < end; i++) {
+            int64_t v = metric_value(&samples[i], m);
+            if (v < 0) return 0;  // not measured on this platform
+            if (low[w] < 0 || v < low[w]) low[w] = v;
+        }
+    }
+
+    int rising = 1;
+    for (int w = 1; w < WINDOWS; w++) {
+        if (low[w] < low[w - 1]) rising = 0;
+    }
+    int64_t growth = low[WINDOWS - 1] - low[0];
+    int grew = rising && growth > m->slack_kb;
+    log_info("Soak: %-9s lows %lld, %lld, %lld, %lld KB%s", m->name,
+             (long long)low[0], (long long)low[1], (long long)low[2], (long long)low[3],
+             grew ? "  <- keeps growing" : "");
+    return grew;
+}
+
+static void write_samples(int count) {
+    FILE *f = fopen(out_path, "w");
+    if (!f) {
+        log_error("Could not write soak samples: %s", out_path);
+        return;
+    }
+    fprintf(f, "hours,rss_kb,heap_used_kb,heap_free_kb\n");
+    for (int i = 0; i < count; i++) {
+        const SoakSample *s = &samples[i];
+        fprintf(f, "%.3f,%lld,%lld,%lld\n", s->hours, (long long)s->mem.rss_kb,
+                (long long)s->mem.heap_used_kb, (long long)s->mem.heap_free_kb);
+    }
+    fclose(f);
+}
+
+int soak_finish(void) {
+    if (!active) return 0;
+    active = 0;
+    take_sample(timing_now());
+
+    int count = sample_count < MAX_SAMPLES ? sample_count : MAX_SAMPLES;
+    if (out_path) write_samples(count);
+
+    int first = 0;
+    while (first < count && samples[first].hours * 3600.0 < WARMUP_S) first++;
+    if (count - first < WINDOWS * 2) {
+        log_warn("Soak: %d samples after the warm-up, too few to judge", count - first);
+        return 0;
+    }
+
+    int grew = 0;
+    for (size_t i = 0; i < sizeof(metrics) / sizeof(metrics[0]); i++) {
+        grew |= metric_grew(&metrics[i], first, count - first);
+    }
+    log_info("Soak: %.1f h, %d samples: %s", samples[count - 1].hours, count,
+             grew ? "memory keeps growing" : "no steady growth");
+    return grew;
+}
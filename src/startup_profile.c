@@ -0,0 +1,80 @@
+#include <stdio.h>
+#include <stdbool.h>
+
+#include <SDL.h>
+
+#include "startup_profile.h"
+#include "platform.h"
+#include "trace.h"
+
+#define MAX_PHASES 32
+#define NS_PER_MS  1000000.0
+
+typedef struct {
+    const char *name;
+    uint64_t    begin;
+    uint64_t    end;
+    AllocCounts allocs;
+    SDL_atomic_t ready;   // set once the fields above are written
+} Phase;
+
+// Phases also end on the audio-init workers, so slots are claimed atomically
+static bool         enabled     = false;
+static SDL_atomic_t first_frame;           // the first present has happened
+static uint64_t     origin      = 0;
+static Phase        phases[MAX_PHASES];
+static SDL_atomic_t phase_count;
+
+void startup_profile_enable(void) {
+    enabled = true;
+    origin  = platform_monotonic_ns();
+}
+
+int startup_profile_enabled(void) {
+    return enabled;
+}
+
+StartupMark startup_phase_begin(void) {
+#ifdef ENABLE_TRACE
+    uint64_t ns = platform_monotonic_ns();   // the trace wants startup phases too
+#else
+    uint64_t ns = enabled ? platform_monotonic_ns() : 0;
+#endif
+    return (StartupMark){ ns, alloc_stats_thread() };
+}
+
+void startup_phase_end(const char *name, StartupMark begin) {
+    TRACE_COMPLETE(name, begin.ns, platform_monotonic_ns());
+    if (!enabled || SDL_AtomicGet(&first_frame)) return;
+    int slot = SDL_AtomicAdd(&phase_count, 1);
+    if (slot >= MAX_PHASES) return;
+    Phase *p  = &phases[slot];
+    p->name   = name;
+    p->begin  = begin.ns;
+    p->end    = platform_monotonic_ns();
+    p->allocs = alloc_stats_since(begin.allocs);
+    SDL_AtomicSet(&p->ready, 1);  // full barrier: the fields are visible before the flag
+}
+
+void startup_frame_presented(void) {
+    if (SDL_AtomicSet(&first_frame, 1)) return;
+    if (!enabled) return;
+
+    // one line per phase: name, start and duration in ms since main(), then
+    // allocations and KB requested (zero unless --alloc-stats)
+    uint64_t now = platform_monotonic_ns();
+    printf("%-24s %10s %10s %8s %10s\n", "phase", "at_ms", "took_ms", "allocs", "alloc_kb");
+    int count = SDL_AtomicGet(&phase_count);
+    if (count > MAX_PHASES) count = MAX_PHASES;
+    for (int i = 0; i < count; i++) {
+        if (!SDL_AtomicGet(&phases[i].ready)) continue;  // a worker is still writing it
+        printf("%-24s %10.3f %10.3f %8llu %10.1f\n",
+               phases[i].name,
+               (phases[i].begin - origin) / NS_PER_MS,
+               (phases[i].end - phases[i].begin) / NS_PER_MS,
+               (unsigned long long)phases[i].allocs.count,
+               phases[i].allocs.bytes / 1024.0);
+    }
+    printf("%-24s %10.3f\n", "first_frame", (now - origin) / NS_PER_MS);
+    fflush(stdout);
+}
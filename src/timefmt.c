@@ -0,0 +1,130 @@
+#include <stdint.h>
+#include <time.h>
+
+#include "timefmt.h"
+
+#define SECONDS_PER_DAY 86400
+#define SCAN_DAYS       366   // look this far each way for a DST transition
+#define RECHECK_S       60    // how often the zone is re-read, to notice a change
+
+// A span of time with one UTC offset
+typedef struct {
+    int     valid;
+    time_t  from;     // first second with this offset
+    time_t  until;    // first second after it
+    int64_t offset;   // local - UTC, in seconds
+} OffsetSpan;
+
+// Two spans, so "now" and a timetable row across a DST change don't evict each other
+static OffsetSpan spans[2];
+static int        last_used = 0;
+static time_t     next_check = 0;   // wall clock time of the next zone re-read
+
+// Helper: days since 1970-01-01 for a proleptic Gregorian date (Howard Hinnant's algorithm)
+static int64_t days_from_civil(int64_t y, int m, int d) {
+    y -= m <= 2;
+    int64_t era = (y >= 0 ? y : y - 399) / 400;
+    int64_t yoe = y - era * 400;
+    int64_t doy = (153 * (m + (m > 2 ? -3 : 9)) + 2) / 5 + d - 1;
+    int64_t doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    return era * 146097 + doe - 719468;
+}
+
+// Helper: the one place that asks the C library
+static int64_t offset_at(time_t t) {
+    struct tm lt = *localtime(&t);
+    int64_t local = days_from_civil(lt.tm_year + 1900, lt.tm_mon + 1, lt.tm_mday) * SECONDS_PER_DAY
+               + lt.tm_hour * 3600 + lt.tm_min * 60 + lt.tm_sec;
+    return local - (int64_t)t;
+}
+
+// Helper: first second in (inside, outside] whose offset differs from `offset`,
+// given that `outside` has a different one
+static time_t find_transition(time_t inside, time_t outside, int64_t offset) {
+    while (outside - inside > 1 || inside - outside > 1) {
+        time_t mid = inside + (outside - inside) / 2;
+        if (offset_at(mid) == offset) inside = mid;
+        else outside = mid;
+    }
+    return outside;
+}
+
+// Helper: measure the span of constant offset around `t`. Runs once per DST period.
+static void compute_span(OffsetSpan *span, time_t t) {
+    int64_t offset = offset_at(t);
+
+    time_t until = t;
+    for (int day = 1; day <= SCAN_DAYS; day++) {
+        time_t probe = t + (time_t)day * SECONDS_PER_DAY;
+        if (offset_at(probe) != offset) {
+            until = find_transition(probe - SECONDS_PER_DAY, probe, offset);
+            break;
+        }
+        until = probe;
+    }
+
+    time_t from = t;
+    for (int day = 1; day <= SCAN_DAYS; day++) {
+        time_t probe = t - (time_t)day * SECONDS_PER_DAY;
+        if (offset_at(probe) != offset) {
+            from = find_transition(probe + SECONDS_PER_DAY, probe, offset) + 1;
+            break;
+        }
+        from = probe;
+    }
+
+    span->valid  = 1;
+    span->from   = from;
+    span->until  = until;
+    span->offset = offset;
+}
+
+static int64_t lookup_offset(time_t t) {
+    // The zone can change under a running app (TZ edited, or the machine moved and
+    // the system zone was switched). Re-read it now and then and drop the spans it
+    // disagrees with. Whether an edited zone file is noticed without a TZ change is
+    // up to the C library's tzset().
+    time_t now = time(NULL);
+    if (now >= next_check || now < next_check - RECHECK_S) {
+        next_check = now + RECHECK_S;
+        tzset();
+        for (int i = 0; i < 2; i++) {
+            if (spans[i].valid && offset_at(spans[i].from) != spans[i].offset) spans[i].valid = 0;
+        }
+    }
+
+    for (int i = 0; i < 2; i++) {
+        if (spans[i].valid && t >= spans[i].from && t < spans[i].until) {
+            last_used = i;
+            return spans[i].offset;
+        }
+    }
+
+    // miss: replace the span used less recently
+    int victim = 1 - last_used;
+    compute_span(&spans[victim], t);
+    last_used = victim;
+    return spans[victim].offset;
+}
+
+void timefmt_split(time_t t, int *hour, int *min, int *sec) {
+    int64_t local = (int64_t)t + lookup_offset(t);
+    int64_t sod   = ((local % SECONDS_PER_DAY) + SECONDS_PER_DAY) % SECONDS_PER_DAY;
+    *hour = (int)(sod / 3600);
+    *min  = (int)(sod / 60 % 60);
+    *sec  = (int)(sod % 60);
+}
+
+void timefmt_hms(time_t t, char out[9]) {
+    int h, m, s;
+    timefmt_split(t, &h, &m, &s);
+    out[0] = (char)('0' + h / 10); out[1] = (char)('0' + h % 10); out[2] = ':';
+    out[3] = (char)('0' + m / 10); out[4] = (char)('0' + m % 10); out[5] = ':';
+    out[6] = (char)('0' + s / 10); out[7] = (char)('0' + s % 10); out[8] = '\0';
+}
+
+void timefmt_invalidate(void) {
+    tzset();
+    spans[0].valid = 0;
+    spans[1].valid = 0;
+}
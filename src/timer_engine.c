@@ -0,0 +1,143 @@
+#include <stdlib.h>
+#include <math.h>
+
+#include "timer_engine.h"
+
+#define DEFAULT_TICK_SECONDS 0.5
+#define STALE_ALARM_SECONDS  5.0  // a phase that ended longer ago than this (suspend) ends silently
+
+typedef struct {
+    TimerListener fn;
+    void         *user;
+} Listener;
+
+struct TimerEngine {
+    SchedulePlan      *plan;      // borrowed
+    int                current;   // phase running now; == plan->count when done
+    int                started;   // PHASE_START of phase 0 emitted
+    int                stopped;
+    double             tick;
+    const TimingClock *clock;     // NULL: timing_now()/timing_sleep_until()
+    Listener           listeners[TIMER_ENGINE_MAX_LISTENERS];
+    int                num_listeners;
+};
+
+TimerEngine *timer_engine_create(SchedulePlan *plan, const TimingClock *clock) {
+    if (!plan) return NULL;
+
+    TimerEngine *engine = calloc(1, sizeof(*engine));
+    if (!engine) return NULL;
+
+    engine->plan  = plan;
+    engine->tick  = DEFAULT_TICK_SECONDS;
+    engine->clock = clock;
+    return engine;
+}
+
+void timer_engine_destroy(TimerEngine *engine) {
+    free(engine);
+}
+
+int timer_engine_subscribe(TimerEngine *engine, TimerListener listener, void *user) {
+    if (!listener || engine->num_listeners >= TIMER_ENGINE_MAX_LISTENERS) return -1;
+    engine->listeners[engine->num_listeners++] = (Listener){ listener, user };
+    return 0;
+}
+
+void timer_engine_set_tick(TimerEngine *engine, double seconds) {
+    if (seconds > 0.0) engine->tick = seconds;
+}
+
+void timer_engine_stop(TimerEngine *engine) {
+    engine->stopped = 1;
+}
+
+int timer_engine_done(const TimerEngine *engine) {
+    return engine->current >= engine->plan->count;
+}
+
+int timer_engine_current(const TimerEngine *engine) {
+    return engine->current;
+}
+
+// Helper: the engine's clock
+static double engine_now(const TimerEngine *engine) {
+    return engine->clock ? engine->clock->now(engine->clock->ctx) : timing_now();
+}
+
+static void emit(TimerEngine *engine, TimerEventType type, double now, int stale) {
+    TimerEvent ev = { type, -1, NULL, now, 0.0, 0.0, stale };
+
+    if (engine->current < engine->plan->count) {
+        const TimerPhaseSpan *span = &engine->plan->phases[engine->current];
+        double length    = span->end - span->start;
+        double remaining = span->end - now;
+        if (remaining < 0.0) remaining = 0.0;
+
+        ev.phase     = engine->current;
+        ev.span      = span;
+        ev.remaining = remaining;
+        ev.fraction  = length > 0.0 ? remaining / length : 0.0;
+        if (ev.fraction > 1.0) ev.fraction = 1.0;
+    }
+
+    for (int i = 0; i < engine->num_listeners; i++) {
+        engine->listeners[i].fn(&ev, engine->listeners[i].user);
+    }
+}
+
+double timer_engine_poll(TimerEngine *engine) {
+    double now = engine_now(engine);
+    if (timer_engine_done(engine)) return now;
+
+    if (!engine->started) {
+        engine->started = 1;
+        emit(engine, TIMER_EVENT_PHASE_START, now, 0);
+    }
+
+    // close the running phase once its end has passed
+    if (now >= engine->plan->phases[engine->current].end) {
+        double end = engine->plan->phases[engine->current].end;
+        emit(engine, TIMER_EVENT_TICK, now, 0);  // the final 0:00 frame
+        emit(engine, TIMER_EVENT_PHASE_END, now, 0);
+        emit(engine, TIMER_EVENT_ALARM, now, now - end >= STALE_ALARM_SECONDS);
+
+        // after a suspend, jump straight to the phase containing now;
+        // the phases slept through end silently
+        int next = schedule_plan_find(engine->plan, now);
+        if (next <= engine->current) next = engine->current + 1;
+        engine->current = next;
+        emit(engine, timer_engine_done(engine) ? TIMER_EVENT_DONE : TIMER_EVENT_PHASE_START, now, 0);
+    }
+    if (timer_engine_done(engine)) return now;
+
+    emit(engine, TIMER_EVENT_TICK, now, 0);
+
+    // next tick on the tick grid, but never past the end of the phase
+    double next = (floor(now / engine->tick) + 1.0) * engine->tick;
+    double end  = engine->plan->phases[engine->current].end;
+    return next < end ? next : end;
+}
+
+void timer_engine_run(TimerEngine *engine) {
+    while (!engine->stopped && !timer_engine_done(engine)) {
+        double next = timer_engine_poll(engine);
+        if (engine->stopped || timer_engine_done(engine)) break;
+
+        if (engine->clock) {
+            engine->clock->sleep_until(engine->clock->ctx, next);
+        } else {
+            timing_sleep_until(next);
+        }
+    }
+}
+
+void timer_engine_skip(TimerEngine *engine) {
+    if (timer_engine_done(engine)) return;
+    schedule_plan_skip(engine->plan, engine->current, engine_now(engine));
+}
+
+void timer_engine_extend(TimerEngine *engine, double seconds) {
+    if (timer_engine_done(engine)) return;
+    schedule_plan_extend(engine->plan, engine->current, seconds);
+}
@@ -0,0 +1,140 @@
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "timing.h"
+#include "platform.h"
+
+#define NS_PER_SEC 1000000000.0
+#define WALL_STEP_SECONDS 2.0  // wall clock vs anchored time: beyond this it was stepped
+
+static bool     anchored    = false;
+static int64_t  anchor_wall = 0;   // wall clock at the anchor, ns since epoch
+static uint64_t anchor_boot = 0;   // boot clock at the anchor
+static int64_t  last_sleep_ns = 0; // boot - monotonic at the last suspend check
+
+static const TimingClock *clock_override = NULL;
+
+// Built-in virtual clock (timing_use_virtual_clock)
+typedef struct {
+    double   start;       // virtual time at install
+    uint64_t boot_start;  // boot clock at install (scaled mode)
+    double   speed;       // <= 0: stepped
+    double   stepped_now; // current time in stepped mode
+} VirtualClock;
+
+static VirtualClock virtual_clock;
+static TimingClock  virtual_clock_iface;
+
+static double real_now(void *ctx);
+static void   real_sleep_until(void *ctx, double deadline);
+static const TimingClock real_clock_iface = { real_now, real_sleep_until, NULL };
+
+// Helper: time spent suspended so far = how far the boot clock ran ahead of monotonic
+static int64_t suspended_ns(void) {
+    return (int64_t)(platform_boottime_ns() - platform_monotonic_ns());
+}
+
+void timing_init(void) {
+    if (anchored) return;
+    timing_resync();
+    last_sleep_ns = suspended_ns();
+}
+
+void timing_resync(void) {
+    anchor_boot = platform_boottime_ns();
+    anchor_wall = platform_wall_ns();
+    anchored    = true;
+}
+
+double timing_now(void) {
+    if (clock_override) return clock_override->now(clock_override->ctx);
+    return real_now(NULL);
+}
+
+static double real_now(void *ctx) {
+    (void)ctx;
+    if (!anchored) timing_init();
+    uint64_t elapsed = platform_boottime_ns() - anchor_boot;
+    return (anchor_wall + (int64_t)elapsed) / NS_PER_SEC;
+}
+
+double timing_check_wall(void) {
+    if (clock_override) return 0.0;  // virtual time has no wall clock to follow
+    if (!anchored) timing_init();
+    double moved = platform_wall_ns() / NS_PER_SEC - real_now(NULL);
+    if (moved > -WALL_STEP_SECONDS && moved < WALL_STEP_SECONDS) return 0.0;
+    timing_resync();
+    return moved;
+}
+
+double timing_suspend_gap(void) {
+    if (clock_override) return 0.0;  // virtual time has no suspend
+    if (!anchored) timing_init();
+    int64_t now = suspended_ns();
+    int64_t gap = now - last_sleep_ns;
+    last_sleep_ns = now;
+    // the two clocks are read a few ns apart; ignore anything below a millisecond
+    return gap > 1000000 ? gap / NS_PER_SEC : 0.0;
+}
+
+void timing_sleep_until(double deadline) {
+    if (clock_override) {
+        clock_override->sleep_until(clock_override->ctx, deadline);
+        return;
+    }
+    real_sleep_until(NULL, deadline);
+}
+
+static void real_sleep_until(void *ctx, double deadline) {
+    (void)ctx;
+    if (!anchored) timing_init();
+    double left = deadline - real_now(NULL);
+    if (left <= 0.0) return;
+    platform_sleep_until_ns(platform_boottime_ns() + (uint64_t)(left * NS_PER_SEC));
+}
+
+void timing_sleep(double seconds) {
+    timing_sleep_until(timing_now() + seconds);
+}
+
+void timing_set_clock(const TimingClock *clock) {
+    clock_override = clock;
+}
+
+int timing_is_virtual(void) {
+    return clock_override != NULL;
+}
+
+const TimingClock *timing_current_clock(void) {
+    return clock_override ? clock_override : &real_clock_iface;
+}
+
+static double virtual_now(void *ctx) {
+    VirtualClock *vc = ctx;
+    if (vc->speed <= 0.0) return vc->stepped_now;
+    uint64_t elapsed = platform_boottime_ns() - vc->boot_start;
+    return vc->start + elapsed / NS_PER_SEC * vc->speed;
+}
+
+static void virtual_sleep_until(void *ctx, double deadline) {
+    VirtualClock *vc = ctx;
+    if (vc->speed <= 0.0) {
+        if (deadline > vc->stepped_now) vc->stepped_now = deadline;
+        return;
+    }
+    double left = (deadline - virtual_now(vc)) / vc->speed;  // in real seconds
+    if (left <= 0.0) return;
+    platform_sleep_until_ns(platform_boottime_ns() + (uint64_t)(left * NS_PER_SEC));
+}
+
+void timing_use_virtual_clock(double start, double speed) {
+    virtual_clock.start       = start;
+    virtual_clock.boot_start  = platform_boottime_ns();
+    virtual_clock.speed       = speed;
+    virtual_clock.stepped_now = start;
+
+    virtual_clock_iface.now         = virtual_now;
+    virtual_clock_iface.sleep_until = virtual_sleep_until;
+    virtual_clock_iface.ctx         = &virtual_clock;
+    timing_set_clock(&virtual_clock_iface);
+}
@@ -0,0 +1,251 @@
+#include "trace.h"
+
+#ifdef ENABLE_TRACE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <signal.h>
+
+#include <SDL.h>
+
+#include "cJSON.h"
+#include "platform.h"
+#include "logger.h"
+
+#define MAX_TRACE_THREADS 32       // live threads; events from any beyond this are dropped
+#define BUFFER_EVENTS     (1 << 16) // per thread, a power of two; the oldest are overwritten
+
+enum { SLOT_FREE, SLOT_OWNED, SLOT_RETIRED };  // retired: the thread exited, events kept
+
+typedef struct {
+    const char *name;
+    uint64_t    ts_ns;
+    uint64_t    dur_ns;   // 'X' only
+    double      value;    // 'C' only
+    char        phase;    // 'B', 'E', 'X' or 'C'
+} TraceEvent;
+
+// Ring buffer. Only the owning thread writes; `count` publishes what the writer may
+// read. It runs up to 2 * BUFFER_EVENTS and then wraps back to BUFFER_EVENTS, so
+// count & (BUFFER_EVENTS - 1) is always the next slot. `gen` is odd while a retired
+// slot passes to a new thread, so a dump never mixes two threads' events.
+typedef struct {
+    SDL_atomic_t state;
+    SDL_atomic_t gen;
+    SDL_atomic_t count;
+    SDL_threadID tid;
+    const char  *thread_name;
+    TraceEvent  *events;
+} TraceBuffer;
+
+static TraceBuffer            buffers[MAX_TRACE_THREADS];
+static __thread TraceBuffer  *my_buffer = NULL;
+static SDL_atomic_t           dropped;
+static int                    enabled   = 0;
+static uint64_t               origin_ns = 0;
+static char                   trace_path[1024] = "";
+static volatile sig_atomic_t  dump_requested = 0;
+
+// Helper: take over a slot in state `from`; NULL when there is none
+static TraceBuffer *claim_slot(int from) {
+    for (int i = 0; i < MAX_TRACE_THREADS; i++) {
+        TraceBuffer *b = &buffers[i];
+        if (!SDL_AtomicCAS(&b->state, from, SLOT_OWNED)) continue;
+
+        SDL_AtomicAdd(&b->gen, 1);   // odd: a dump skips the slot
+        if (!b->events) b->events = malloc(sizeof(TraceEvent) * BUFFER_EVENTS);
+        b->tid         = SDL_ThreadID();
+        b->thread_name = NULL;
+        SDL_AtomicSet(&b->count, 0);
+        SDL_AtomicAdd(&b->gen, 1);
+        if (!b->events) {
+            SDL_AtomicSet(&b->state, from);
+            return NULL;
+        }
+        return b;
+    }
+    return NULL;
+}
+
+// Helper: the calling thread's buffer, claimed on first use. Unused slots go first,
+// so an exited thread's events stay in the trace for as long as possible.
+static TraceBuffer *thread_buffer(void) {
+    if (my_buffer) return my_buffer;
+    my_buffer = claim_slot(SLOT_FREE);
+    if (!my_buffer) my_buffer = claim_slot(SLOT_RETIRED);
+    return my_buffer;
+}
+
+static void record(char phase, const char *name, uint64_t ts_ns, uint64_t dur_ns, double value) {
+    if (!enabled) return;
+    TraceBuffer *b = thread_buffer();
+    if (!b) {
+        SDL_AtomicAdd(&dropped, 1);
+        return;
+    }
+    int n = SDL_AtomicGet(&b->count);
+    b->events[n & (BUFFER_EVENTS - 1)] = (TraceEvent){ name, ts_ns, dur_ns, value, phase };
+    int next = n + 1;
+    if (next == 2 * BUFFER_EVENTS) next = BUFFER_EVENTS;
+    SDL_AtomicSet(&b->count, next);   // publish after the event is written
+}
+
+#if defined(SIGUSR1)
+static void on_dump_signal(int sig) {
+    (void)sig;
+    dump_requested = 1;   // async-signal-safe: the main loop does the writing
+}
+#endif
+
+void trace_init(void) {
+    origin_ns = platform_monotonic_ns();
+    enabled   = 1;
+#if defined(SIGUSR1)
+    signal(SIGUSR1, on_dump_signal);
+#endif
+    atexit(trace_write);
+}
+
+void trace_set_output(const char *path) {
+    snprintf(trace_path, sizeof(trace_path), "%s", path);
+}
+
+void trace_thread_name(const char *name) {
+    TraceBuffer *b = thread_buffer();
+    if (b) b->thread_name = name;
+}
+
+void trace_thread_exit(void) {
+    if (!my_buffer) return;
+    SDL_AtomicSet(&my_buffer->state, SLOT_RETIRED);
+    my_buffer = NULL;
+}
+
+void trace_begin(const char *name) {
+    record('B', name, platform_monotonic_ns(), 0, 0.0);
+}
+
+void trace_end(const char *name) {
+    record('E', name, platform_monotonic_ns(), 0, 0.0);
+}
+
+void trace_complete(const char *name, uint64_t begin_ns, uint64_t end_ns) {
+    record('X', name, begin_ns, end_ns - begin_ns, 0.0);
+}
+
+void trace_counter(const char *name, double value) {
+    record('C', name, platform_monotonic_ns(), 0, value);
+}
+
+void trace_poll(void) {
+    if (dump_requested) {
+        dump_requested = 0;
+        trace_write();
+    }
+}
+
+// Helper: timestamps in the trace are microseconds since trace_init
+static double trace_us(uint64_t ns) {
+    return (double)(int64_t)(ns - origin_ns) / 1000.0;
+}
+
+// Helper: copy a buffer's events, oldest first, into `out`. Returns how many are
+// whole, or -1 when the slot changed hands during the copy. A live owner keeps
+// writing meanwhile; the oldest events it may have overwritten are left out.
+static int snapshot(TraceBuffer *b, TraceEvent *out, SDL_threadID *tid, const char **thread_name) {
+    int gen = SDL_AtomicGet(&b->gen);
+    if (gen & 1) return -1;
+    int writing = b != my_buffer && SDL_AtomicGet(&b->state) == SLOT_OWNED;
+    *tid         = b->tid;
+    *thread_name = b->thread_name;
+
+    int n     = SDL_AtomicGet(&b->count);
+    int len   = n < BUFFER_EVENTS ? n : BUFFER_EVENTS;
+    int first = n - len;  // oldest, in the same numbering as n
+    for (int e = 0; e < len; e++) {
+        out[e] = b->events[(first + e) & (BUFFER_EVENTS - 1)];
+    }
+
+    int later = SDL_AtomicGet(&b->count);
+    if (SDL_AtomicGet(&b->gen) != gen) return -1;
+    if (later < n) later += BUFFER_EVENTS;   // count wrapped back meanwhile
+    // slots up to `later` minus one lap may be overwritten, and `later` itself may
+    // be in the middle of a write
+    int stale = later - BUFFER_EVENTS + writing - first;
+    if (stale <= 0) return len;
+    if (stale >= len) return 0;
+    memmove(out, out + stale, sizeof(TraceEvent) * (len - stale));
+    return len - stale;
+}
+
+void trace_write(void) {
+    if (!enabled || !trace_path[0]) return;
+
+    TraceEvent *copy = malloc(sizeof(TraceEvent) * BUFFER_EVENTS);
+    if (!copy) {
+        log_error("Trace: out of memory while writing");
+        return;
+    }
+    cJSON *root   = cJSON_CreateObject();
+    cJSON *events = cJSON_AddArrayToObject(root, "traceEvents");
+    cJSON_AddStringToObject(root, "displayTimeUnit", "ms");
+
+    for (int i = 0; i < MAX_TRACE_THREADS; i++) {
+        TraceBuffer *b = &buffers[i];
+        if (SDL_AtomicGet(&b->state) == SLOT_FREE) continue;
+        SDL_threadID tid;
+        const char  *thread_name;
+        int n = snapshot(b, copy, &tid, &thread_name);
+        if (n < 0) continue;
+
+        if (thread_name) {
+            cJSON *meta = cJSON_CreateObject();
+            cJSON_AddStringToObject(meta, "name", "thread_name");
+            cJSON_AddStringToObject(meta, "ph", "M");
+            cJSON_AddNumberToObject(meta, "pid", 1);
+            cJSON_AddNumberToObject(meta, "tid", (double)tid);
+            cJSON *args = cJSON_AddObjectToObject(meta, "args");
+            cJSON_AddStringToObject(args, "name", thread_name);
+            cJSON_AddItemToArray(events, meta);
+        }
+
+        for (int e = 0; e < n; e++) {
+            const TraceEvent *ev = &copy[e];
+            char ph[2] = { ev->phase, '\0' };
+            cJSON *item = cJSON_CreateObject();
+            cJSON_AddStringToObject(item, "name", ev->name);
+            cJSON_AddStringToObject(item, "ph", ph);
+            cJSON_AddNumberToObject(item, "ts", trace_us(ev->ts_ns));
+            cJSON_AddNumberToObject(item, "pid", 1);
+            cJSON_AddNumberToObject(item, "tid", (double)tid);
+            if (ev->phase == 'X') {
+                cJSON_AddNumberToObject(item, "dur", ev->dur_ns / 1000.0);
+            } else if (ev->phase == 'C') {
+                cJSON *args = cJSON_AddObjectToObject(item, "args");
+                cJSON_AddNumberToObject(args, "value", ev->value);
+            }
+            cJSON_AddItemToArray(events, item);
+        }
+    }
+    free(copy);
+
+    char *json = cJSON_PrintUnformatted(root);
+    cJSON_Delete(root);
+    if (!json) {
+        log_error("Trace: out of memory while printing");
+        return;
+    }
+
+    FILE *f = fopen(trace_path, "w");
+    if (!f) {
+        log_error("Trace: cannot write %s", trace_path);
+    } else {
+        fputs(json, f);
+        fclose(f);
+        log_info("Trace written to %s (%d events dropped)", trace_path, SDL_AtomicGet(&dropped));
+    }
+    cJSON_free(json);
+}
+
+#endif
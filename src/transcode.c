@@ -0,0 +1,215 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+
+#include <SDL.h>
+#include <SDL_mixer.h>
+
+#include "transcode.h"
+#include "platform.h"
+#include "worker.h"
+#include "music.h"
+#include "logger.h"
+
+#define WAV_HEADER_SIZE 44
+#define MAX_WORKERS     2    // each holds a whole decoded track in memory
+
+// state of each cache entry
+enum {
+    CACHE_PENDING = 0,
+    CACHE_READY   = 1,
+    CACHE_FAILED  = 2
+};
+
+typedef struct {
+    char         src[MAX_PATH_LEN];
+    char         dst[MAX_PATH_LEN];
+    int          freq;    // device rate in the name of dst
+    SDL_atomic_t state;
+} CacheEntry;
+
+static WorkerPool   *pool        = NULL;
+static CacheEntry   *entries     = NULL;
+static int           entry_count = 0;
+static SDL_atomic_t  cancelled;
+
+// Helper: little-endian writers for the WAV header
+static void put_le16(Uint8 *p, Uint16 v) {
+    p[0] = v & 0xFF;
+    p[1] = (v >> 8) & 0xFF;
+}
+
+static void put_le32(Uint8 *p, Uint32 v) {
+    p[0] = v & 0xFF;
+    p[1] = (v >> 8) & 0xFF;
+    p[2] = (v >> 16) & 0xFF;
+    p[3] = (v >> 24) & 0xFF;
+}
+
+// Helper: the cached copy exists and is not older than its source
+static bool is_up_to_date(const char *src, const char *dst) {
+    struct stat ss, ds;
+    if (stat(src, &ss) != 0 || stat(dst, &ds) != 0) return false;
+    return ds.st_size > WAV_HEADER_SIZE && ds.st_mtime >= ss.st_mtime;
+}
+
+// Helper: file name without its directory
+static const char *base_name(const char *path) {
+    const char *slash = strrchr(path, '/');
+    const char *sep   = strrchr(path, PLATFORM_PATH_SEP);
+    const char *base  = slash > sep ? slash : sep;
+    return base ? base + 1 : path;
+}
+
+int transcode_file(const char *src, const char *dst) {
+    int freq, channels;
+    Uint16 format;
+    if (!Mix_QuerySpec(&freq, &format, &channels)) return -1;
+
+    // WAV only stores little-endian PCM; anything else keeps using the source
+    Uint16 tag;
+    if (format == AUDIO_S16LSB)      tag = 1;  // integer PCM
+    else if (format == AUDIO_F32LSB) tag = 3;  // IEEE float
+    else return -1;
+
+    // Mix_LoadWAV decodes the whole track and converts it to the device format
+    Mix_Chunk *chunk = Mix_LoadWAV(src);
+    if (!chunk) {
+        log_error("Mix_LoadWAV Error (%s): %s", src, Mix_GetError());
+        return -1;
+    }
+
+    // the header must describe the format the data was converted to
+    int loaded_freq, loaded_channels;
+    Uint16 loaded_format;
+    if (!Mix_QuerySpec(&loaded_freq, &loaded_format, &loaded_channels) ||
+        loaded_freq != freq || loaded_format != format || loaded_channels != channels) {
+        Mix_FreeChunk(chunk);
+        return -1;
+    }
+
+    Uint16 bits  = SDL_AUDIO_BITSIZE(format);
+    Uint16 align = channels * bits / 8;
+    Uint8 header[WAV_HEADER_SIZE];
+    memcpy(header,      "RIFF", 4);
+    put_le32(header + 4,  36 + chunk->alen);
+    memcpy(header + 8,  "WAVEfmt ", 8);
+    put_le32(header + 16, 16);
+    put_le16(header + 20, tag);
+    put_le16(header + 22, channels);
+    put_le32(header + 24, freq);
+    put_le32(header + 28, freq * align);
+    put_le16(header + 32, align);
+    put_le16(header + 34, bits);
+    memcpy(header + 36, "data", 4);
+    put_le32(header + 40, chunk->alen);
+
+    // write next to the destination and rename, so a half-written file is never played
+    char tmp[MAX_PATH_LEN + 8];
+    snprintf(tmp, sizeof(tmp), "%s.part", dst);
+    FILE *f = fopen(tmp, "wb");
+    if (!f) {
+        log_error("Could not create cache file: %s", tmp);
+        Mix_FreeChunk(chunk);
+        return -1;
+    }
+    int ok = fwrite(header, 1, sizeof(header), f) == sizeof(header)
+          && fwrite(chunk->abuf, 1, chunk->alen, f) == chunk->alen;
+    ok = (fclose(f) == 0) && ok;
+    Mix_FreeChunk(chunk);
+
+    if (!ok) {
+        log_error("Short write when creating cache file: %s", tmp);
+        remove(tmp);
+        return -1;
+    }
+
+    remove(dst);  // rename() does not replace on Windows
+    if (rename(tmp, dst) != 0) {
+        remove(tmp);
+        return -1;
+    }
+    return 0;
+}
+
+static void transcode_job(void *arg) {
+    CacheEntry *e = arg;
+    if (SDL_AtomicGet(&cancelled)) return;
+
+    audio_device_hold();
+    // the device may have been reopened at another rate since the name was chosen
+    int freq, channels;
+    Uint16 format;
+    int ok = Mix_QuerySpec(&freq, &format, &channels) && freq == e->freq
+          && transcode_file(e->src, e->dst) == 0;
+    audio_device_release();
+    SDL_AtomicSet(&e->state, ok ? CACHE_READY : CACHE_FAILED);
+}
+
+int transcode_cache_start(const Settings *settings, char *const *paths, int count) {
+    int freq, channels;
+    Uint16 format;
+
+    transcode_cache_stop();
+    if (count <= 0 || !Mix_QuerySpec(&freq, &format, &channels)) return -1;
+
+    char cache_dir[MAX_PATH_LEN];
+    if (snprintf(cache_dir, sizeof(cache_dir), "%s%ccache",
+                 settings->asset_directory, PLATFORM_PATH_SEP) >= (int)sizeof(cache_dir)) {
+        log_error("Cache directory path too long: %s", settings->asset_directory);
+        return -1;
+    }
+    if (platform_mkdir_p(cache_dir) != 0) {
+        log_error("Failed to create cache directory: %s", cache_dir);
+        return -1;
+    }
+
+    entries = calloc(count, sizeof(CacheEntry));
+    if (!entries) return -1;
+    entry_count = count;
+
+    // the device rate is part of the name, so a rate change never plays a stale copy
+    int todo = 0;
+    for (int i = 0; i < count; i++) {
+        CacheEntry *e = &entries[i];
+        snprintf(e->src, sizeof(e->src), "%s", paths[i]);
+        e->freq = freq;
+        if (snprintf(e->dst, sizeof(e->dst), "%s%c%s.%d.wav", cache_dir, PLATFORM_PATH_SEP,
+                     base_name(paths[i]), freq) >= (int)sizeof(e->dst)) {
+            SDL_AtomicSet(&e->state, CACHE_FAILED);  // no room for the name: play the source
+        } else if (is_up_to_date(e->src, e->dst)) {
+            SDL_AtomicSet(&e->state, CACHE_READY);
+        } else {
+            todo++;
+        }
+    }
+    if (todo == 0) return 0;
+
+    SDL_AtomicSet(&cancelled, 0);
+    pool = worker_pool_create(MAX_WORKERS, SDL_THREAD_PRIORITY_LOW, "transcode");
+    if (!pool) return -1;
+
+    for (int i = 0; i < count; i++) {
+        if (SDL_AtomicGet(&entries[i].state) == CACHE_PENDING) {
+            worker_pool_submit(pool, transcode_job, &entries[i]);
+        }
+    }
+    return 0;
+}
+
+const char *transcode_cached_path(int index, const char *original) {
+    if (!entries || index < 0 || index >= entry_count) return original;
+    if (SDL_AtomicGet(&entries[index].state) != CACHE_READY) return original;
+    return entries[index].dst;
+}
+
+void transcode_cache_stop(void) {
+    SDL_AtomicSet(&cancelled, 1);
+    worker_pool_destroy(pool);   // joins the workers before the table goes away
+    pool = NULL;
+
+    free(entries);
+    entries     = NULL;
+    entry_count = 0;
+}
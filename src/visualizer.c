@@ -0,0 +1,229 @@
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+
+#include <SDL.h>
+#include <SDL_mixer.h>
+
+#include "visualizer.h"
+
+#define FFT_SIZE    1024              // real samples per analysis frame
+#define FFT_HALF    (FFT_SIZE / 2)    // complex FFT length after packing
+#define RING_SIZE   8192              // power of two, ~170 ms of mono at 48 kHz
+#define NUM_BARS    48
+#define LOW_HZ      40.0
+#define HIGH_HZ     16000.0
+#define FLOOR_DB    -70.0f
+#define BAR_DECAY   0.85f             // fraction of the previous level kept per frame
+
+// SPSC ring: the mixer thread owns `head`, the render thread owns `tail`.
+static float        ring[RING_SIZE];
+static SDL_atomic_t ring_head;
+static SDL_atomic_t ring_tail;
+
+static bool   active          = false;
+static int    capture_channels = 2;
+static Uint16 capture_format   = AUDIO_S16SYS;
+
+// analysis tables, computed once in visualizer_start()
+static float history[FFT_SIZE];           // most recent FFT_SIZE samples, oldest first
+static float window[FFT_SIZE];            // Hann
+static float tw_re[FFT_HALF], tw_im[FFT_HALF];         // per-stage twiddles, stage h at [h-1, 2h-1)
+static float split_re[FFT_HALF], split_im[FFT_HALF];   // e^{-2 pi i k / FFT_SIZE}
+static int   bitrev[FFT_HALF];
+static int   band_lo[NUM_BARS], band_hi[NUM_BARS];     // bin range of each bar
+static float levels[NUM_BARS];                         // 0..1, smoothed
+
+// scratch, SoA so the butterflies vectorise
+static float re[FFT_HALF], im[FFT_HALF];
+static float power[FFT_HALF];
+
+// geometry is rebuilt in place every frame; indices never change
+static SDL_Vertex verts[NUM_BARS * 4];
+static int        indices[NUM_BARS * 6];
+
+void visualizer_capture(void *udata, Uint8 *stream, int len) {
+    (void)udata;
+    int bytes    = SDL_AUDIO_BITSIZE(capture_format) / 8;
+    int frames   = len / (bytes * capture_channels);
+    int head     = SDL_AtomicGet(&ring_head);
+    int tail     = SDL_AtomicGet(&ring_tail);
+    int space    = RING_SIZE - 1 - ((head - tail) & (RING_SIZE - 1));
+    if (frames > space) frames = space;   // the reader is behind: drop, never wait
+
+    for (int i = 0; i < frames; i++) {
+        float l, r;
+        if (SDL_AUDIO_ISFLOAT(capture_format)) {
+            l = ((float *)stream)[i * capture_channels];
+            r = ((float *)stream)[i * capture_channels + (capture_channels > 1)];
+        } else {
+            l = ((Sint16 *)stream)[i * capture_channels] * (1.0f / 32768.0f);
+            r = ((Sint16 *)stream)[i * capture_channels + (capture_channels > 1)] * (1.0f / 32768.0f);
+        }
+        ring[(head + i) & (RING_SIZE - 1)] = 0.5f * (l + r);
+    }
+    SDL_MemoryBarrierRelease();
+    SDL_AtomicSet(&ring_head, (head + frames) & (RING_SIZE - 1));
+}
+
+int visualizer_start(void) {
+    int freq;
+    if (!Mix_QuerySpec(&freq, &capture_format, &capture_channels)) return -1;
+    if (capture_format != AUDIO_S16SYS && capture_format != AUDIO_F32SYS) return -1;
+
+    for (int n = 0; n < FFT_SIZE; n++) {
+        window[n] = 0.5f - 0.5f * (float)cos(2.0 * M_PI * n / (FFT_SIZE - 1));
+    }
+    for (int h = 1; h < FFT_HALF; h <<= 1) {
+        for (int j = 0; j < h; j++) {
+            tw_re[h - 1 + j] = (float)cos(-M_PI * j / h);
+            tw_im[h - 1 + j] = (float)sin(-M_PI * j / h);
+        }
+    }
+    for (int k = 0; k < FFT_HALF; k++) {
+        split_re[k] = (float)cos(-2.0 * M_PI * k / FFT_SIZE);
+        split_im[k] = (float)sin(-2.0 * M_PI * k / FFT_SIZE);
+    }
+    int bits = 0;
+    while ((1 << bits) < FFT_HALF) bits++;
+    for (int i = 0; i < FFT_HALF; i++) {
+        int r = 0;
+        for (int b = 0; b < bits; b++) r |= ((i >> b) & 1) << (bits - 1 - b);
+        bitrev[i] = r;
+    }
+
+    // log-spaced bands; each gets at least one bin
+    double bin_hz = (double)freq / FFT_SIZE;
+    for (int b = 0; b < NUM_BARS; b++) {
+        double lo = LOW_HZ * pow(HIGH_HZ / LOW_HZ, (double)b / NUM_BARS);
+        double hi = LOW_HZ * pow(HIGH_HZ / LOW_HZ, (double)(b + 1) / NUM_BARS);
+        band_lo[b] = (int)(lo / bin_hz);
+        band_hi[b] = (int)(hi / bin_hz);
+        if (band_lo[b] < 1) band_lo[b] = 1;
+        if (band_hi[b] <= band_lo[b]) band_hi[b] = band_lo[b] + 1;
+        if (band_hi[b] > FFT_HALF) band_hi[b] = FFT_HALF;
+        if (band_lo[b] >= band_hi[b]) band_lo[b] = band_hi[b] - 1;
+    }
+
+    for (int b = 0; b < NUM_BARS; b++) {
+        int v = b * 4;
+        int *ix = &indices[b * 6];
+        ix[0] = v; ix[1] = v + 1; ix[2] = v + 2;
+        ix[3] = v; ix[4] = v + 2; ix[5] = v + 3;
+    }
+
+    memset(history, 0, sizeof(history));
+    memset(levels, 0, sizeof(levels));
+    SDL_AtomicSet(&ring_head, 0);
+    SDL_AtomicSet(&ring_tail, 0);
+    Mix_SetPostMix(visualizer_capture, NULL);
+    active = true;
+    return 0;
+}
+
+void visualizer_stop(void) {
+    if (!active) return;
+    Mix_SetPostMix(NULL, NULL);
+    active = false;
+}
+
+bool visualizer_active(void) {
+    return active;
+}
+
+// Helper: in-place radix-2 FFT of re/im (length FFT_HALF), input already bit-reversed
+static void fft_half(void) {
+    for (int h = 1; h < FFT_HALF; h <<= 1) {
+        const float *wr = &tw_re[h - 1];
+        const float *wi = &tw_im[h - 1];
+        for (int i = 0; i < FFT_HALF; i += 2 * h) {
+            float *ar = &re[i], *ai = &im[i];
+            float *br = &re[i + h], *bi = &im[i + h];
+            for (int j = 0; j < h; j++) {
+                float tr = br[j] * wr[j] - bi[j] * wi[j];
+                float ti = br[j] * wi[j] + bi[j] * wr[j];
+                br[j] = ar[j] - tr;
+                bi[j] = ai[j] - ti;
+                ar[j] += tr;
+                ai[j] += ti;
+            }
+        }
+    }
+}
+
+void visualizer_analyse(void) {
+    if (!active) return;
+
+    // drain everything the mixer produced, keeping the newest FFT_SIZE samples
+    int head = SDL_AtomicGet(&ring_head);
+    SDL_MemoryBarrierAcquire();
+    int tail = SDL_AtomicGet(&ring_tail);
+    int avail = (head - tail) & (RING_SIZE - 1);
+    if (avail > FFT_SIZE) {
+        tail = (tail + avail - FFT_SIZE) & (RING_SIZE - 1);
+        avail = FFT_SIZE;
+    }
+    memmove(history, history + avail, (FFT_SIZE - avail) * sizeof(float));
+    for (int i = 0; i < avail; i++) {
+        history[FFT_SIZE - avail + i] = ring[(tail + i) & (RING_SIZE - 1)];
+    }
+    SDL_AtomicSet(&ring_tail, (tail + avail) & (RING_SIZE - 1));
+
+    // pack even/odd real samples as one complex sequence of half the length
+    for (int n = 0; n < FFT_HALF; n++) {
+        int r = bitrev[n];
+        re[r] = history[2 * n] * window[2 * n];
+        im[r] = history[2 * n + 1] * window[2 * n + 1];
+    }
+    fft_half();
+
+    // unpack into the spectrum of the real signal: X[k] for k < FFT_HALF
+    for (int k = 0; k < FFT_HALF; k++) {
+        int m = (FFT_HALF - k) & (FFT_HALF - 1);
+        float er = 0.5f * (re[k] + re[m]), ei = 0.5f * (im[k] - im[m]);
+        float or_ = 0.5f * (im[k] + im[m]), oi = -0.5f * (re[k] - re[m]);
+        float xr = er + split_re[k] * or_ - split_im[k] * oi;
+        float xi = ei + split_re[k] * oi + split_im[k] * or_;
+        power[k] = xr * xr + xi * xi;
+    }
+
+    // band energies in dB, mapped to 0..1; bars fall back slowly
+    const float norm = 4.0f / ((float)FFT_SIZE * FFT_SIZE);  // Hann gain 0.5, one-sided spectrum
+    for (int b = 0; b < NUM_BARS; b++) {
+        float sum = 0.0f;
+        for (int k = band_lo[b]; k < band_hi[b]; k++) sum += power[k];
+        float db = 10.0f * log10f(sum * norm + 1e-12f);
+        float level = (db - FLOOR_DB) / -FLOOR_DB;
+        if (level < 0.0f) level = 0.0f;
+        if (level > 1.0f) level = 1.0f;
+        levels[b] = level > levels[b] * BAR_DECAY ? level : levels[b] * BAR_DECAY;
+    }
+}
+
+int visualizer_render(SDL_Renderer *renderer, int cx, int cy, int radius) {
+    if (!active) return 0;
+    visualizer_analyse();
+
+    float inner = radius + 6.0f;
+    float reach = radius * 0.35f;
+    float half  = (float)M_PI / NUM_BARS * 0.6f;   // angular half-width of a bar
+    SDL_Color color = {200, 200, 200, 255};
+
+    for (int b = 0; b < NUM_BARS; b++) {
+        float a   = 2.0f * (float)M_PI * b / NUM_BARS;
+        float out = inner + 1.0f + levels[b] * reach;
+        float s0 = sinf(a - half), c0 = cosf(a - half);
+        float s1 = sinf(a + half), c1 = cosf(a + half);
+        SDL_Vertex *v = &verts[b * 4];
+        v[0].position = (SDL_FPoint){ cx + s0 * inner, cy - c0 * inner };
+        v[1].position = (SDL_FPoint){ cx + s1 * inner, cy - c1 * inner };
+        v[2].position = (SDL_FPoint){ cx + s1 * out,   cy - c1 * out   };
+        v[3].position = (SDL_FPoint){ cx + s0 * out,   cy - c0 * out   };
+        for (int k = 0; k < 4; k++) {
+            v[k].color = color;
+            v[k].tex_coord = (SDL_FPoint){0.0f, 0.0f};
+        }
+    }
+    SDL_RenderGeometry(renderer, NULL, verts, NUM_BARS * 4, indices, NUM_BARS * 6);
+    return 1;
+}
@@ -0,0 +1,147 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+
+#include "worker.h"
+#include "logger.h"
+#include "trace.h"
+
+typedef struct Job {
+    WorkerJob    fn;
+    void        *arg;
+    struct Job  *next;
+} Job;
+
+struct WorkerPool {
+    SDL_Thread       **threads;
+    int                num_threads;
+    SDL_ThreadPriority priority;
+    const char        *name;
+    SDL_mutex         *lock;
+    SDL_cond          *has_work;
+    SDL_cond          *idle;
+    Job               *head;
+    Job               *tail;
+    int                running;      // jobs currently executing
+    bool               quit;
+};
+
+static int worker_main(void *data) {
+    WorkerPool *pool = data;
+    SDL_SetThreadPriority(pool->priority);
+    TRACE_THREAD_NAME(pool->name);
+
+    SDL_LockMutex(pool->lock);
+    while (1) {
+        while (!pool->head && !pool->quit) {
+            SDL_CondWait(pool->has_work, pool->lock);
+        }
+        if (pool->quit) break;
+
+        // pop the oldest job
+        Job *job = pool->head;
+        pool->head = job->next;
+        if (!pool->head) pool->tail = NULL;
+        pool->running++;
+        SDL_UnlockMutex(pool->lock);
+
+        job->fn(job->arg);
+        free(job);
+
+        SDL_LockMutex(pool->lock);
+        pool->running--;
+        if (!pool->head && pool->running == 0) {
+            SDL_CondBroadcast(pool->idle);
+        }
+    }
+    SDL_UnlockMutex(pool->lock);
+    logger_thread_exit();
+    TRACE_THREAD_EXIT();
+    return 0;
+}
+
+WorkerPool *worker_pool_create(int threads, SDL_ThreadPriority priority, const char *name) {
+    if (threads <= 0) threads = SDL_GetCPUCount();
+    if (threads <= 0) threads = 1;
+
+    WorkerPool *pool = calloc(1, sizeof(WorkerPool));
+    if (!pool) return NULL;
+
+    pool->priority = priority;
+    pool->name     = name;
+    pool->lock     = SDL_CreateMutex();
+    pool->has_work = SDL_CreateCond();
+    pool->idle     = SDL_CreateCond();
+    pool->threads  = calloc(threads, sizeof(SDL_Thread*));
+    if (!pool->lock || !pool->has_work || !pool->idle || !pool->threads) {
+        worker_pool_destroy(pool);
+        return NULL;
+    }
+
+    for (int i = 0; i < threads; i++) {
+        pool->threads[i] = SDL_CreateThread(worker_main, name, pool);
+        if (!pool->threads[i]) {
+            log_error("SDL_CreateThread Error: %s", SDL_GetError());
+            break;
+        }
+        pool->num_threads++;
+    }
+
+    if (pool->num_threads == 0) {
+        worker_pool_destroy(pool);
+        return NULL;
+    }
+    return pool;
+}
+
+int worker_pool_submit(WorkerPool *pool, WorkerJob fn, void *arg) {
+    Job *job = malloc(sizeof(Job));
+    if (!job) return -1;
+    job->fn   = fn;
+    job->arg  = arg;
+    job->next = NULL;
+
+    SDL_LockMutex(pool->lock);
+    if (pool->tail) pool->tail->next = job;
+    else            pool->head = job;
+    pool->tail = job;
+    SDL_CondSignal(pool->has_work);
+    SDL_UnlockMutex(pool->lock);
+    return 0;
+}
+
+void worker_pool_wait(WorkerPool *pool) {
+    SDL_LockMutex(pool->lock);
+    while (pool->head || pool->running > 0) {
+        SDL_CondWait(pool->idle, pool->lock);
+    }
+    SDL_UnlockMutex(pool->lock);
+}
+
+void worker_pool_destroy(WorkerPool *pool) {
+    if (!pool) return;
+
+    if (pool->lock) {
+        SDL_LockMutex(pool->lock);
+        pool->quit = true;
+        // pending jobs are dropped. their args belong to the submitter.
+        while (pool->head) {
+            Job *next = pool->head->next;
+            free(pool->head);
+            pool->head = next;
+        }
+        pool->tail = NULL;
+        SDL_CondBroadcast(pool->has_work);
+        SDL_UnlockMutex(pool->lock);
+    }
+
+    for (int i = 0; i < pool->num_threads; i++) {
+        SDL_WaitThread(pool->threads[i], NULL);
+    }
+
+    free(pool->threads);
+    if (pool->idle)     SDL_DestroyCond(pool->idle);
+    if (pool->has_work) SDL_DestroyCond(pool->has_work);
+    if (pool->lock)     SDL_DestroyMutex(pool->lock);
+    free(pool);
+}
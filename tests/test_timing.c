@@ -0,0 +1,175 @@
+// Drift tests for the timing core and the timer engine, on simulated clocks: a whole
+// study day runs in milliseconds and every reading is reproducible.
+//
+// usage: test_timing        (exit status 1 on any failure)
+#include <stdio.h>
+#include <math.h>
+#include <stdint.h>
+
+#include "timing.h"
+#include "schedule.h"
+#include "timer_engine.h"
+
+#define START      1700000000.0   // on the 0.5 s tick grid
+#define TICK       0.5
+#define MAX_LATE   0.2            // the jittery clock wakes up to this late
+
+static int failures = 0;
+
+#define CHECK(cond, ...) do {                      \
+    if (!(cond)) {                                 \
+        failures++;                                \
+        printf("FAIL %s:%d: ", __FILE__, __LINE__); \
+        printf(__VA_ARGS__);                       \
+        printf("\n");                              \
+    }                                              \
+} while (0)
+
+// A clock whose sleeps end late by a varying amount, like a loaded machine
+typedef struct {
+    double   now;
+    uint32_t rng;
+} JitterClock;
+
+static double jitter_now(void *ctx) {
+    return ((JitterClock *)ctx)->now;
+}
+
+static void jitter_sleep_until(void *ctx, double deadline) {
+    JitterClock *c = ctx;
+    c->rng ^= c->rng << 13;
+    c->rng ^= c->rng >> 17;
+    c->rng ^= c->rng << 5;
+    double late = (c->rng % 1000) / 1000.0 * MAX_LATE;
+    if (deadline + late > c->now) c->now = deadline + late;
+}
+
+// What a run of the engine looked like
+typedef struct {
+    const SchedulePlan *plan;
+    int    ticks;
+    int    phase_ends;
+    int    done;
+    double worst_tick_lag;   // tick time minus the grid point before it
+    double worst_end_lag;    // PHASE_END time minus the planned end
+} Run;
+
+static void on_event(const TimerEvent *ev, void *user) {
+    Run *run = user;
+    switch (ev->type) {
+    case TIMER_EVENT_TICK: {
+        run->ticks++;
+        double lag = ev->now - floor(ev->now / TICK) * TICK;
+        if (lag > run->worst_tick_lag) run->worst_tick_lag = lag;
+        break;
+    }
+    case TIMER_EVENT_PHASE_END: {
+        run->phase_ends++;
+        double lag = ev->now - ev->span->end;
+        if (lag > run->worst_end_lag) run->worst_end_lag = lag;
+        break;
+    }
+    case TIMER_EVENT_DONE:
+        run->done++;
+        break;
+    default:
+        break;
+    }
+}
+
+// Helper: a day of eight 50/10 sessions with a long break every fourth
+static SchedulePlan *make_day(void) {
+    ScheduleSpec spec = { 50 * 60, 10 * 60, 30 * 60, 4, 8 };
+    return schedule_plan_create(&spec, START, START);
+}
+
+static void run_day(const TimingClock *clock, Run *run) {
+    SchedulePlan *plan = make_day();
+    TimerEngine *engine = plan ? timer_engine_create(plan, clock) : NULL;
+    if (!engine) {
+        CHECK(0, "could not create the plan or engine");
+        schedule_plan_destroy(plan);
+        return;
+    }
+    *run = (Run){ plan, 0, 0, 0, 0.0, 0.0 };
+    timer_engine_subscribe(engine, on_event, run);
+    timer_engine_set_tick(engine, TICK);
+    timer_engine_run(engine);
+
+    CHECK(run->done == 1, "DONE emitted %d times", run->done);
+    CHECK(run->phase_ends == plan->count, "%d phase ends for %d phases", run->phase_ends, plan->count);
+    timer_engine_destroy(engine);
+    schedule_plan_destroy(plan);
+}
+
+// The stepped clock lands exactly on every deadline: one tick per grid point,
+// every phase ends on time
+static void test_stepped_engine(void) {
+    timing_use_virtual_clock(START, 0.0);
+    Run run;
+    run_day(NULL, &run);
+
+    double day = (8 * 50 + 6 * 10 + 30) * 60.0;   // 8 sessions, 7 breaks, one long
+    CHECK(timing_now() == START + day, "day ended at %+.6f s", timing_now() - (START + day));
+    CHECK(run.worst_tick_lag == 0.0, "a tick was %.6f s off the grid", run.worst_tick_lag);
+    CHECK(run.worst_end_lag == 0.0, "a phase ended %.6f s late", run.worst_end_lag);
+    // one tick per grid point, plus the final 0:00 frame of every phase
+    int expected = (int)(day / TICK) + 15;
+    CHECK(run.ticks == expected, "%d ticks, expected %d", run.ticks, expected);
+    timing_set_clock(NULL);
+}
+
+// Late wakeups must not add up: deadlines are absolute, so the lag after a whole
+// day is no worse than after one sleep
+static void test_jitter_does_not_accumulate(void) {
+    JitterClock jc = { START, 0x9e3779b9u };
+    TimingClock clock = { jitter_now, jitter_sleep_until, &jc };
+    Run run;
+    run_day(&clock, &run);
+
+    CHECK(run.worst_tick_lag <= MAX_LATE + 1e-6, "a tick lagged %.3f s", run.worst_tick_lag);
+    CHECK(run.worst_end_lag <= MAX_LATE + 1e-6, "a phase ended %.3f s late", run.worst_end_lag);
+}
+
+// Relative sleeps round to epoch-sized doubles (one ulp, 2.4e-7 s, per sleep), so
+// they may drift by that much each; absolute deadlines do not drift at all. The
+// session loop only ever sleeps to absolute deadlines.
+static void test_stepped_sleeps(void) {
+    timing_use_virtual_clock(START, 0.0);
+    for (int i = 0; i < 36000; i++) {
+        timing_sleep(0.1);
+    }
+    double off = timing_now() - (START + 3600.0);
+    CHECK(fabs(off) <= 36000 * 2.4e-7, "an hour of 0.1 s sleeps ended %+.6f s off", off);
+
+    for (int i = 1; i <= 7200; i++) {
+        timing_sleep_until(START + 3600.0 + i * TICK);
+    }
+    CHECK(timing_now() == START + 7200.0, "deadlines ended %+.9f s off", timing_now() - (START + 7200.0));
+    CHECK(timing_suspend_gap() == 0.0, "a virtual clock reported a suspend");
+    CHECK(timing_check_wall() == 0.0, "a virtual clock followed the wall clock");
+    timing_set_clock(NULL);
+}
+
+// A sleep that is already due returns at once and never moves the clock back
+static void test_past_deadline(void) {
+    timing_use_virtual_clock(START, 0.0);
+    timing_sleep_until(START + 10.0);
+    timing_sleep_until(START + 5.0);
+    CHECK(timing_now() == START + 10.0, "clock at %+.3f s after a past deadline", timing_now() - START);
+    timing_set_clock(NULL);
+}
+
+int main(void) {
+    test_stepped_engine();
+    test_jitter_does_not_accumulate();
+    test_stepped_sleeps();
+    test_past_deadline();
+
+    if (failures) {
+        printf("test_timing: %d failure(s)\n", failures);
+        return 1;
+    }
+    printf("test_timing: ok\n");
+    return 0;
+}